@@ -14,6 +14,10 @@
 #include <imgui_impl_sdl.h>
 #include <imgui_impl_opengl3.h>
 
+#include <atomic>
+
+// the main thread handles events, simulates and builds the ui, the render
+// thread owns the gl context; frames go across as snapshots (frameSnapshot.hpp)
 class Application {
 public:
     Application();
@@ -24,7 +28,11 @@ public:
     void handleEvents();
     void updateFunc();
     void setupFunc();
-    void renderFunc();
+    // render thread, draws the newest snapshot; false if none came in
+    bool renderFunc();
+    // hand the context to the render thread and take it back
+    void startRendering();
+    void stopRendering();
     void clean();
 
     bool running() { return isRunning; }
@@ -37,6 +45,10 @@ private:
     SDL_Window* gWindow = NULL;
     SDL_GLContext gContext;
     SDL_Surface* gScreenSurface = NULL;
+
+    static int renderThread(void* data);
+    SDL_Thread* gRenderThread = NULL;
+    std::atomic<bool> isRendering { false };
 };
 
 #endif
\ No newline at end of file
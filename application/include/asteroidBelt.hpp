@@ -0,0 +1,55 @@
+#ifndef ASTEROIDBELT_HPP
+#define ASTEROIDBELT_HPP
+
+#include "glewInc.hpp"
+#include "frustum.hpp"
+#include "streamBuffer.hpp"
+#include "kepler.hpp"
+
+#include <vector>
+
+// keplerian belt, orbital elements are kept as structure of arrays so the
+// propagation runs 4 bodies per SSE lane group on every core and writes the
+// instance buffer (xyz position, w scale) in place. the instances are streamed,
+// every frame lands at a new offset of getBuffer()
+class AsteroidBelt {
+public:
+    AsteroidBelt() {}
+
+    // draws new elements for count bodies around radius and sizes the instance buffer
+    void create(int count, float radius);
+    // advances every body by dt seconds of simulated time and packs the ones
+    // inside the frustum to the front of the instance buffer, with cull off
+    // every body is written and the gpu does the culling
+    void update(float dt, const Frustum &frustum, bool cull = true);
+    // bounding radius of the rock mesh at scale 1
+    void setMeshRadius(float radius) { meshRadius = radius; }
+
+    GLuint getBuffer() { return instances.getID(); }
+    // where this frame's instances start in getBuffer()
+    GLintptr getOffset() { return offset; }
+    int getCount() { return count; }
+    int getVisibleCount() { return visibleCount; }
+    double getUpdateMs() { return updateMs; }
+    // the path of body i around focus, the sun in render space
+    OrbitPath getOrbit(int i, const glm::fvec3 &focus) const;
+
+private:
+    int count = 0;
+    int padded = 0;
+    int visibleCount = 0;
+    float meshRadius = 1.0f;
+    StreamBuffer instances;
+    GLintptr offset = 0;
+    double updateMs = 0.0;
+
+    // orbital plane -> scene axes scaled by the semi-axes,
+    // position = (cos E - e) * p + sin E * q
+    std::vector<float> px, py, pz;
+    std::vector<float> qx, qy, qz;
+    std::vector<float> eccentricity;
+    std::vector<float> meanAnomaly, meanMotion;
+    std::vector<float> scale;
+};
+
+#endif
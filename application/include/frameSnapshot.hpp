@@ -0,0 +1,142 @@
+#ifndef FRAMESNAPSHOT_HPP
+#define FRAMESNAPSHOT_HPP
+
+#include "glewInc.hpp"
+#include "node.hpp"
+#include "frustum.hpp"
+#include "glState.hpp"
+#include "shader.hpp"
+#include "allocations.hpp"
+#include "renderQueue.hpp"
+#include "dynamicResolution.hpp"
+#include "streamBuffer.hpp"
+#include "orbitRenderer.hpp"
+#include "starCatalogue.hpp"
+#include "tripleBuffer.hpp"
+
+#include <SDL.h>
+#include <imgui.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// the main thread simulates and runs the ui, the render thread owns the gl
+// context; they only share what goes through the two triple buffers below
+
+// the gui's settings as they were when the frame was simulated
+struct RenderSettings {
+    float shininess;
+    float ambient;
+    float lightIntensity;
+    float reflectivity;
+    float lightConstant;
+    float lightLinear;
+    float lightQuadratic;
+    float exposure;
+    float gamma;
+    float glow;
+    float sharpness;
+    float targetFrameMs;
+    float speedSlider;
+    float starMagnitude;
+    int asteroidCount;
+    bool planetOutline;
+    bool planetBloom;
+    bool blur;
+    bool grayscale;
+    bool verticalMirror;
+    bool horizontalMirror;
+    bool stars;
+    bool beltOrbits;
+    bool realism;
+    bool bloomFlag;
+    bool gpuCulling;
+    bool occlusionCulling;
+    bool dynamicRes;
+};
+
+// one visible node of the scene graph. node is only used for what never changes
+// after setup (textures) and what only the render thread touches (occludedFrames)
+struct BodySnapshot {
+    Node* node;
+    BodyType type;
+    glm::dmat4 world;
+    // relative to the camera
+    glm::fmat4 render;
+    // rings reach past the body, their bounds are a sphere of their own
+    bool ring;
+    glm::fmat4 ringModel;
+    glm::fmat4 ringBounds;
+    // render space, culled by the orbit renderer
+    bool orbit;
+    OrbitPath orbitPath;
+};
+
+struct CameraSnapshot {
+    glm::dvec3 position;
+    // rotation only, render space
+    glm::fmat4 view;
+    glm::dmat4 worldView;
+    glm::fmat4 projection;
+};
+
+// ImGui owns its draw lists and rebuilds them on the next NewFrame, the render
+// thread draws copies; their buffers are reused so steady frames do not allocate.
+// ImGui's io is the main thread's, the framebuffer scale travels with the copy
+class UiSnapshot {
+public:
+    UiSnapshot() {}
+    ~UiSnapshot();
+    UiSnapshot(const UiSnapshot&) = delete;
+    UiSnapshot &operator=(const UiSnapshot&) = delete;
+
+    // main thread, clip rects come out already in framebuffer pixels
+    void copy(const ImDrawData* source, const ImVec2 &scale);
+    const ImDrawData* getDrawData() const { return &drawData; }
+    const ImVec2 &getFramebufferScale() const { return framebufferScale; }
+
+private:
+    ImVector<ImDrawList*> lists;
+    ImDrawData drawData;
+    ImVec2 framebufferScale = ImVec2(1.0f, 1.0f);
+};
+
+struct FrameSnapshot {
+    // SDL ticks the transforms were taken at
+    Uint32 ticks = 0;
+    CameraSnapshot camera;
+    RenderSettings settings;
+    std::vector<BodySnapshot> bodies;
+    // render space
+    glm::fvec3 lightPosition;
+    glm::fvec3 worldOrigin;
+    // heap allocations while the scene graph was walked, should stay 0
+    unsigned long long traversalAllocations = 0;
+    UiSnapshot ui;
+};
+
+// the other way round, what the render thread measured, for the debug viewer
+struct RenderStats {
+    CullingStats culling;
+    RenderQueueStats queue;
+    AllocationStats allocations;
+    ShaderStats shaders;
+    ShaderCacheStats shaderCache;
+    GLStateStats glState;
+    ResolutionStats resolution;
+    OrbitStats orbits;
+    StarStats stars;
+    StreamStats streams;
+    bool persistentStreams = false;
+    double beltMs = 0.0;
+    GLuint verticesUsed = 0;
+    GLuint vertexCapacity = 0;
+    GLuint indicesUsed = 0;
+    GLuint indexCapacity = 0;
+};
+
+extern TripleBuffer<FrameSnapshot> snapshots;
+extern TripleBuffer<RenderStats> renderStats;
+
+#endif
@@ -5,20 +5,27 @@
 
 #include "texture.hpp"
 #include "model.hpp"
+#include "kepler.hpp"
 
 #include <vector>
 
 // toggle movement of planets
 extern bool isMoving;
 
+// picks the draw routine, set once when the node is created
+enum BodyType {
+    BODY_ROOT, BODY_SUN, BODY_EARTH, BODY_PLANET, BODY_RINGED_PLANET
+};
+
 class Node {
 public:
     Node() {}
     Node(std::string aName, float aDistance, float aRotationSpeed, float aSize, 
-         float aSelfRotSpeed, std::string aTexturePath = "");
+         float aSelfRotSpeed, std::string aTexturePath = "", BodyType aType = BODY_PLANET);
     
     void setName(std::string aName);    
     std::string &getName() { return name; }
+    BodyType getType() { return type; }
 
     void addChild(Node* node); 
     Node* &getChild(std::string aName);
@@ -29,14 +36,23 @@ public:
     Node* &getParent() { return parent; }
 
     void setLocalTransform(glm::fmat4& mat = glm::fmat4(1.0f));
-    void setWorldTransform(glm::fmat4& mat = glm::fmat4(1.0f));
+    // composes in double and refreshes the camera-relative render transform
+    void setWorldTransform(const glm::dmat4& mat = glm::dmat4(1.0));
     glm::fmat4 &getLocalTransform() { return localTransform; }
-    glm::fmat4 &getWorldTransform() { return worldTransform; }
+    glm::dmat4 &getWorldTransform() { return worldTransform; }
+    // what the children orbit in: this body's world position and scale, none of its turning
+    glm::dmat4 &getOrbitalFrame() { return orbitalFrame; }
+    // world transform relative to the camera, what the gpu and the culling see
+    glm::fmat4 &getRenderTransform() { return renderTransform; }
     
     float &getSize() { return size; }
     float &getRotationSpeed() { return rotationSpeed; }
     float &getDistanceFromOrigin() { return distanceFromOrigin; }  
     float &getSelfRotSpeed() { return selfRotSpeed; }   
+    // shape and tilt of the orbit in radians, distanceFromOrigin is its semi-major
+    // axis and rotationSpeed its mean motion; a circle in the xz plane until set
+    void setOrbit(float aEccentricity, float aInclination, float aAscendingNode, float aPeriapsis);
+    OrbitalElements getOrbit();
 
     void setTexture();
     Texture &getTexture() { return texture; }
@@ -46,6 +62,8 @@ public:
     Model &getModel() { return model; }
     
     bool &getVisibility() { return isVisible; }
+    // hi-z tests in a row that found the body hidden
+    int &getOccludedFrames() { return occludedFrames; }
     void setVisibility(bool flag);   
     void toString();
 
@@ -54,14 +72,19 @@ private:
     std::vector<Node*> children;
    
     glm::fmat4 localTransform = glm::fmat4(1.0f);
-    glm::fmat4 worldTransform = glm::fmat4(1.0f);
+    glm::dmat4 worldTransform = glm::dmat4(1.0);
+    glm::dmat4 orbitalFrame = glm::dmat4(1.0);
+    glm::fmat4 renderTransform = glm::fmat4(1.0f);
 
     std::string name;
+    BodyType type = BODY_ROOT;
     float distanceFromOrigin;
     float rotationSpeed;
     float selfRotSpeed;
     float size;
+    OrbitalElements orbit;
     bool isVisible = true;
+    int occludedFrames = 0;
 
     Model model;
     Texture texture;
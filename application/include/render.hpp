@@ -9,31 +9,83 @@
 #include "texture.hpp"
 #include "skybox.hpp"
 #include "framebuffer.hpp"
+#include "uniformBuffer.hpp"
+#include "streamBuffer.hpp"
+#include "glState.hpp"
+#include "material.hpp"
+#include "asteroidBelt.hpp"
+#include "frustum.hpp"
+#include "instanceCuller.hpp"
+#include "allocations.hpp"
+#include "renderQueue.hpp"
+#include "hiZ.hpp"
+#include "dynamicResolution.hpp"
+#include "orbitRenderer.hpp"
+#include "kepler.hpp"
+#include "starCatalogue.hpp"
+#include "frameSnapshot.hpp"
 
+// mirrors the std140 FrameData block declared in the shaders
+const GLuint frameDataBinding = 0;
+
+struct FrameData {
+    glm::fmat4 view;
+    glm::fmat4 projection;
+    glm::fvec3 viewPos;
+    float lightIntensity;
+    glm::fvec3 lightPosition;
+    float lightConstant;
+    float lightLinear;
+    float lightQuadratic;
+    float padding[2];
+    // where the world origin is in render space, for data kept in world
+    // coordinates (belt instances)
+    glm::fvec3 worldOrigin;
+    float padding2;
+};
+static_assert(sizeof(FrameData) == 192, "FrameData must match the std140 layout");
+
+// before the render thread starts, with the context current on the main thread
 void setup();
-void update();
-void render();
-void recursRender(Node& it, glm::fmat4 &mat = glm::fmat4(1.0f));
+// main thread, copies everything the frame needs out of the scene graph,
+// the camera and the gui into frame
+void simulate(FrameSnapshot &frame);
+// render thread, everything that touches gl
+void update(const FrameSnapshot &frame);
+void render(const FrameSnapshot &frame);
+void publishRenderStats();
+
+// world transforms compose in double, see Camera::toRender
+void recursSimulate(Node& it, std::vector<BodySnapshot> &bodies, const glm::dmat4 &mat = glm::dmat4(1.0));
+glm::dmat4 ringTransform(Node& it, const glm::dmat4 &mat, float timer);
+void queueBodies(const std::vector<BodySnapshot> &bodies);
+bool isVisible(const glm::fmat4 &transform, float modelRadius);
+bool isOccluded(const BodySnapshot &body, float modelRadius);
 
 void renderQuad();
 void drawQuad();
 void drawFramebuffer();
 
-void drawRing(Node& it, glm::fmat4 &mat);
-void drawPlanet(Node& it);
-void drawSun(Node& it);
-void drawEarth(Node& it);
-void drawOrbit(Node& it, glm::fmat4& mat);
+// push packets into the render queue instead of drawing
+void queueRing(const BodySnapshot &body);
+void queuePlanet(const BodySnapshot &body);
+void queueSun(const BodySnapshot &body);
+void queueEarth(const BodySnapshot &body);
+void setQueuedProgramConstants();
+// one batched draw for every orbit pushed this frame
+void drawOrbits(const FrameSnapshot &frame);
 void drawStars();
-void drawAsteroid();
+// retested draws the rocks the second hi-z pass brought back
+void drawAsteroid(bool retested = false);
 void drawSkybox();
+// the snapshot's ImGui draw lists with the backend's font texture, touches nothing of ImGui's
+void drawUi(const UiSnapshot &ui);
 
 void initializeFramebuffer();
-void initializeOrbits();
-void initializeStars(unsigned int amount);
+void initializeUi();
 void initializeAsteroids();
 
-void uploadView();
-void uploadProjection();
+void uploadFrameData(const FrameSnapshot &frame);
+void updateMaterials();
 
 #endif
\ No newline at end of file
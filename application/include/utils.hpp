@@ -4,6 +4,7 @@
 #include <string>
 #include "application.hpp"
 #include "node.hpp"
+#include "asteroidBelt.hpp"
 
 const float appVersion = 0.3f;
 
@@ -14,7 +15,9 @@ const std::string resource_path = "C:/Repositories/Solar-System/resources/";
 
 extern bool isMoving;
 extern bool orbits;
+extern bool beltOrbits;
 extern bool stars;
+extern float starMagnitude;
 extern bool realism;
 
 extern float speedSlider;
@@ -37,8 +40,15 @@ extern  bool horizontalMirror;
 extern  bool bloomFlag;
 extern  bool planetBloom;
 extern  bool planetRing;
+extern   int asteroidCount;
+extern  bool gpuCulling;
+extern  bool occlusionCulling;
+extern  bool dynamicRes;
+extern float targetFrameMs;
+extern float sharpness;
 
 extern Node* sg;
+extern AsteroidBelt belt;
 
 // menu
 extern bool menu;
@@ -3,6 +3,7 @@
 #include "controls.hpp"
 #include "gui.hpp"
 
+#include <chrono>
 #include <iostream>
 
 int frame = 0, time, timebase = 0, fps; 
@@ -24,9 +25,9 @@ void Application::init(const char* title, int xpos, int ypos, int width, int hei
         isRunning = false;
         std::cerr << "ERROR::SDL::INIT\n" << SDL_GetError() << std::endl;
     } else {
-        // use OpenGL 3.1 core
+        // OpenGL 3.3 core, the shaders are #version 330 and meshes draw with a base vertex
 	    SDL_GL_SetAttribute( SDL_GL_CONTEXT_MAJOR_VERSION, 3 );
-	    SDL_GL_SetAttribute( SDL_GL_CONTEXT_MINOR_VERSION, 1 );
+	    SDL_GL_SetAttribute( SDL_GL_CONTEXT_MINOR_VERSION, 3 );
 	    SDL_GL_SetAttribute( SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE );
         // create window
         gWindow = SDL_CreateWindow(title, xpos, ypos, width, height, flags);
@@ -74,19 +75,25 @@ void Application::init(const char* title, int xpos, int ypos, int width, int hei
 
 void Application::setupFunc() {
     setup();
+    // creates the font texture while the context is still current here,
+    // ImGui::NewFrame on the main thread needs the atlas built
+    ImGui_ImplOpenGL3_NewFrame();
 }
 
 void Application::handleEvents() {
+    // one frame in flight is enough to overlap simulation and rendering,
+    // running further ahead would only build frames the render thread drops;
+    // waiting before the input is read keeps the latency down
+    // sleeps through the render thread's swap, the timeout only rechecks isRendering
+    while (snapshots.pending() && isRendering) {
+        snapshots.waitAcquired(std::chrono::milliseconds(10));
+    }
     controller();
 }
 
 void Application::updateFunc() {
-    glViewport(0, 0, screenWidth, screenHeight);
-    update();
-}
-
-void Application::renderFunc() {    
-    // fps counter in window title
+    // fps counter in window title; window calls stay on the thread that pumps
+    // its messages, on windows they would wait for it otherwise
     frame++;
 	time = SDL_GetTicks();
 
@@ -94,23 +101,73 @@ void Application::renderFunc() {
 		fps = frame * 1000.0 / (time - timebase);
 	 	timebase = time;
 		frame = 0;
-	}
-    
-    std::string fpstitle = "Solar System @" + std::to_string(fps) + "FPS";
 
-    SDL_SetWindowTitle(gWindow, fpstitle.c_str());  
-    SDL_GL_SwapWindow(gWindow);
+        // once a second is enough, building the string every frame allocated
+        std::string fpstitle = "Solar System @" + std::to_string(fps) + "FPS";
+        SDL_SetWindowTitle(gWindow, fpstitle.c_str());  
+	}
 
     // Start the Dear ImGui frame
-    ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame(gWindow);
     ImGui::NewFrame();
-    
-    render();
     isRunning = drawMenu(); 
-    
+
+    FrameSnapshot& snapshot = snapshots.back();
+    simulate(snapshot);
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());  
+    snapshot.ui.copy(ImGui::GetDrawData(), ImGui::GetIO().DisplayFramebufferScale);
+    snapshots.publish();
+}
+
+bool Application::renderFunc() {
+    if (!snapshots.acquire()) {
+        return false;
+    }
+    const FrameSnapshot& snapshot = snapshots.front();
+    update(snapshot);
+    render(snapshot);
+    // not ImGui_ImplOpenGL3_RenderDrawData, that reads the main thread's io
+    drawUi(snapshot.ui);
+    SDL_GL_SwapWindow(gWindow);
+    publishRenderStats();
+    return true;
+}
+
+int Application::renderThread(void* data) {
+    Application* app = (Application*)data;
+    SDL_GL_MakeCurrent(app->gWindow, app->gContext);
+    while (app->isRendering) {
+        if (!app->renderFunc()) {
+            // the main thread has not finished the next frame yet
+            snapshots.waitPublished(std::chrono::milliseconds(10));
+        }
+    }
+    SDL_GL_MakeCurrent(app->gWindow, NULL);
+    return 0;
+}
+
+void Application::startRendering() {
+    // a context is current on one thread at a time
+    SDL_GL_MakeCurrent(gWindow, NULL);
+    isRendering = true;
+    gRenderThread = SDL_CreateThread(renderThread, "Render Thread", this);
+    if (gRenderThread == NULL) {
+        isRendering = false;
+        isRunning = false;
+        std::cerr << "ERROR::SDL::RENDER_THREAD\n" << SDL_GetError() << std::endl;
+        SDL_GL_MakeCurrent(gWindow, gContext);
+    }
+}
+
+void Application::stopRendering() {
+    if (gRenderThread == NULL) {
+        return;
+    }
+    isRendering = false;
+    SDL_WaitThread(gRenderThread, NULL);
+    gRenderThread = NULL;
+    // ImGui's gl objects are released on this thread in clean()
+    SDL_GL_MakeCurrent(gWindow, gContext);
 }
 
 void Application::clean() {
@@ -0,0 +1,153 @@
+#include "asteroidBelt.hpp"
+#include "jobs.hpp"
+#include "simd.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+void AsteroidBelt::create(int aCount, float radius) {
+    count = aCount > 0 ? aCount : 0;
+    // lanes past count hold harmless copies so kernels never need a tail loop
+    padded = (count + 3) / 4 * 4;
+
+    for (std::vector<float>* v : { &px, &py, &pz, &qx, &qy, &qz, &eccentricity, &meanAnomaly, &meanMotion, &scale }) {
+        v->assign(padded, 0.0f);
+    }
+
+    std::mt19937 rng(1337);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float pi = 3.14159265358979f;
+    // thicker belt for bigger counts so rocks do not pile up
+    float width = std::fmin(0.5f * std::sqrt(count / 1000.0f), 2.5f);
+
+    for (int i = 0; i < padded; i++) {
+        float a = radius + (unit(rng) * 2.0f - 1.0f) * width;
+        float e = 0.05f * unit(rng);
+        float inclination = 0.03f * unit(rng);
+        float node = 2.0f * pi * unit(rng);
+        float periapsis = 2.0f * pi * unit(rng);
+
+        // the same axes the planets and the orbit lines use
+        OrbitalElements elements;
+        elements.semiMajorAxis = a;
+        elements.eccentricity = e;
+        elements.inclination = inclination;
+        elements.ascendingNode = node;
+        elements.periapsis = periapsis;
+        glm::dvec3 p, q;
+        orbitAxes(elements, p, q);
+        px[i] = (float)p.x;
+        py[i] = (float)p.y;
+        pz[i] = (float)p.z;
+        qx[i] = (float)q.x;
+        qy[i] = (float)q.y;
+        qz[i] = (float)q.z;
+
+        eccentricity[i] = e;
+        meanAnomaly[i] = 2.0f * pi * unit(rng);
+        // third law, tuned so the belt sits between the speeds of mars and jupiter
+        meanMotion[i] = 0.025f * std::pow(radius / a, 1.5f);
+        scale[i] = 0.01f + 0.01f * unit(rng);
+    }
+
+    instances.create(GL_ARRAY_BUFFER, (GLsizeiptr)padded * 4 * sizeof(float));
+    offset = 0;
+    visibleCount = 0;
+}
+
+OrbitPath AsteroidBelt::getOrbit(int i, const glm::fvec3 &focus) const {
+    OrbitPath path;
+    path.focus = focus;
+    path.p = glm::fvec3(px[i], py[i], pz[i]);
+    path.q = glm::fvec3(qx[i], qy[i], qz[i]);
+    path.eccentricity = eccentricity[i];
+    return path;
+}
+
+// E - e sin E = M; the second order start is within e^3 for belt eccentricities
+// and one newton step finishes it, sin / cos of E are rotated by the small
+// correction instead of being evaluated again
+static void solveKepler(float4 M, float4 e, float4 &sinE, float4 &cosE) {
+    float4 one = splat(1.0f);
+    float4 sinM, cosM;
+    sincos4(M, sinM, cosM);
+    float4 E = M + e * sinM * (one + e * cosM);
+
+    float4 s, c;
+    sincos4(E, s, c);
+    float4 d = (M - E + e * s) / (one - e * c);
+
+    float4 cosD = one - splat(0.5f) * d * d;
+    sinE = s * cosD + c * d;
+    cosE = c * cosD - s * d;
+}
+
+void AsteroidBelt::update(float dt, const Frustum &frustum, bool cull) {
+    if (count == 0) {
+        visibleCount = 0;
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    float* out = (float*)instances.map((GLsizeiptr)padded * 4 * sizeof(float), offset);
+    std::atomic<int> visible(0);
+    if (out) {
+        const float twoPi = 6.28318530717959f;
+        Jobs::get().parallelFor(padded / 4, [&](int begin, int end) {
+            // survivors are packed per chunk, then copied behind one atomic reservation
+            thread_local std::vector<float> staging;
+            staging.resize((size_t)(end - begin) * 16 + 4);
+            int kept = 0;
+
+            float4 step = splat(dt);
+            for (int block = begin; block < end; block++) {
+                int i = block * 4;
+                // kept wrapped to one revolution so sin4 stays accurate over long runs
+                float4 M = load4(&meanAnomaly[i]) + load4(&meanMotion[i]) * step;
+                M = M - splat(twoPi) * floor4(M * splat(1.0f / twoPi));
+                store4(&meanAnomaly[i], M);
+
+                float4 e = load4(&eccentricity[i]);
+                float4 sinE, cosE;
+                solveKepler(M, e, sinE, cosE);
+                float4 x = cosE - e;
+                float4 y = sinE;
+
+                float4 posX = x * load4(&px[i]) + y * load4(&qx[i]);
+                float4 posY = x * load4(&py[i]) + y * load4(&qy[i]);
+                float4 posZ = x * load4(&pz[i]) + y * load4(&qz[i]);
+                float4 size = load4(&scale[i]);
+
+                int inside = cull ? frustum.testSpheres4(posX, posY, posZ, size * splat(meshRadius)) : 0xF;
+                // padding lanes past count never survive
+                if (i + 4 > count) {
+                    inside &= (1 << (count - i)) - 1;
+                }
+                if (inside == 0) {
+                    continue;
+                }
+
+                // into the interleaved instance layout
+                transpose4(posX, posY, posZ, size);
+                float4 lanes[4] = { posX, posY, posZ, size };
+                // always store, only advance for survivors, keeps the loop free of branches
+                for (int lane = 0; lane < 4; lane++) {
+                    store4(&staging[(size_t)kept * 4], lanes[lane]);
+                    kept += (inside >> lane) & 1;
+                }
+            }
+
+            if (kept > 0) {
+                int base = visible.fetch_add(kept);
+                std::memcpy(out + (size_t)base * 4, staging.data(), (size_t)kept * 4 * sizeof(float));
+            }
+        });
+        instances.unmap();
+    }
+    visibleCount = visible.load();
+
+    updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,37 @@
+#include "frameSnapshot.hpp"
+
+#include <cstring>
+
+UiSnapshot::~UiSnapshot() {
+    for (ImDrawList* list : lists) {
+        IM_DELETE(list);
+    }
+}
+
+// ImVector's assignment frees and reallocates, resize keeps the capacity
+template <typename T>
+static void copyVector(ImVector<T> &dst, const ImVector<T> &src) {
+    dst.resize(src.Size);
+    if (src.Size > 0) {
+        std::memcpy(dst.Data, src.Data, (size_t)src.Size * sizeof(T));
+    }
+}
+
+void UiSnapshot::copy(const ImDrawData* source, const ImVec2 &scale) {
+    while (lists.Size < source->CmdListsCount) {
+        // the copies are never built into, they need no shared data
+        lists.push_back(IM_NEW(ImDrawList)(nullptr));
+    }
+    for (int i = 0; i < source->CmdListsCount; i++) {
+        const ImDrawList* src = source->CmdLists[i];
+        ImDrawList* dst = lists[i];
+        copyVector(dst->CmdBuffer, src->CmdBuffer);
+        copyVector(dst->IdxBuffer, src->IdxBuffer);
+        copyVector(dst->VtxBuffer, src->VtxBuffer);
+        dst->Flags = src->Flags;
+    }
+    drawData = *source;
+    drawData.CmdLists = lists.Data;
+    framebufferScale = scale;
+    drawData.ScaleClipRects(scale);
+}
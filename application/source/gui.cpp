@@ -2,6 +2,13 @@
 #include "node.hpp"
 #include "utils.hpp"
 #include "camera.hpp"
+#include "shader.hpp"
+#include "glState.hpp"
+#include "jobs.hpp"
+#include "frustum.hpp"
+#include "allocations.hpp"
+#include "renderQueue.hpp"
+#include "frameSnapshot.hpp"
 #include "application.hpp"
 
 #include <imgui.h>
@@ -9,9 +16,6 @@
 #include <imgui_impl_opengl3.h>
 #include <iostream>
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/matrix_decompose.hpp>
-
 // menu
 bool menu = true;
 
@@ -29,13 +33,12 @@ static bool showHelp = false;
 
 void drawPlanetViewer(Node& it) {
     
-    if (it.getName() != sg->getName()) {
-        glm::mat4 transformation = it.getWorldTransform(); 
-        glm::vec3 scale, translation, skew;
-        glm::quat rotation;
-        glm::vec4 perspective;
-        glm::decompose(transformation, scale, rotation, translation, skew, perspective);
-        ImGui::Checkbox(("##" + it.getName()).c_str(), &it.getVisibility());
+    if (it.getType() != BODY_ROOT) {
+        // double world position, exact at any distance from the sun
+        glm::dvec3 translation = glm::dvec3(it.getWorldTransform()[3]);
+        ImGui::PushID(&it);
+        ImGui::Checkbox("##visible", &it.getVisibility());
+        ImGui::PopID();
         ImGui::SameLine();
         if (ImGui::Button(it.getName().c_str())) {
             isFollowing = true;
@@ -98,9 +101,17 @@ void drawSettings() {
     ImGui::Separator();
     ImGui::Checkbox("outline", &planetOutline);
     ImGui::Checkbox("show orbits", &orbits);
+    ImGui::Checkbox("show belt orbits", &beltOrbits);
     ImGui::Checkbox("show stars", &stars);
+    ImGui::SliderFloat(" star magnitude limit", &starMagnitude, 0.0f, 12.0f);
     ImGui::Checkbox("show ring", &planetRing);
     ImGui::Checkbox("realistic earth", &realism);
+    ImGui::SliderInt(" asteroids", &asteroidCount, 0, 1000000);
+    ImGui::Checkbox("cull asteroids on the gpu", &gpuCulling);
+    ImGui::Checkbox("occlusion culling (hi-z)", &occlusionCulling);
+    ImGui::Checkbox("dynamic resolution", &dynamicRes);
+    ImGui::SliderFloat(" target frame ms", &targetFrameMs, 4.0f, 50.0f);
+    ImGui::SliderFloat(" sharpness", &sharpness, 0.0f, 1.0f);
 }
 
 void drawCameraViewer() {
@@ -114,7 +125,50 @@ void drawCameraViewer() {
 }
 
 void drawDebugViewer() {
-   
+    // the render thread's counters arrive a frame or two late, never shared live
+    renderStats.acquire();
+    const RenderStats& stats = renderStats.front();
+    ImGui::Text("Frame: %.2f ms (%d asteroids)", 1000.0f / ImGui::GetIO().Framerate, asteroidCount);
+    ImGui::Text("Belt propagation: %.2f ms on %u threads", stats.beltMs, Jobs::get().getThreadCount());
+    ImGui::Text("Depth: %s", getDepthModeName());
+    ImGui::Text("Resolution: %.0f%% (%d x %d), gpu %.2f ms", stats.resolution.scale * 100.0f, stats.resolution.width,
+                stats.resolution.height, stats.resolution.gpuMs);
+    ImGui::Text("Stars: %u of %u to magnitude %.1f (%s)", stats.stars.drawn, stats.stars.loaded, starMagnitude,
+                stats.stars.source);
+    ImGui::Text("Orbits: %u drawn / %u culled, %u vertices in %u draw", stats.orbits.drawn, stats.orbits.culled,
+                stats.orbits.vertices, stats.orbits.draws);
+    ImGui::Text("Streaming (%s): %.2f ms stalled in %u waits, %.1f KB", stats.persistentStreams ? "persistent" : "orphaned",
+                stats.streams.stallMs, stats.streams.stalls, stats.streams.bytes / 1024.0);
+    ImGui::Separator();
+    ImGui::Text("Frustum culling:");
+    ImGui::Text("bodies visible / culled:    %u / %u", stats.culling.nodesVisible, stats.culling.nodesCulled);
+    ImGui::Text("bodies occluded:            %u", stats.culling.nodesOccluded);
+    if (std::string(stats.culling.asteroidPath) == "cpu") {
+        ImGui::Text("asteroids visible / culled: %u / %u", stats.culling.asteroidsVisible, stats.culling.asteroidsCulled);
+    } else {
+        ImGui::Text("asteroids culled on the gpu (%s%s)", stats.culling.asteroidPath,
+                    stats.culling.asteroidOcclusion ? ", hi-z with retest" : "");
+    }
+    ImGui::Separator();
+    ImGui::Text("Heap allocations (last frame): %llu", stats.allocations.frame);
+    ImGui::Text("scene traversal:            %llu", stats.allocations.traversal);
+    ImGui::Separator();
+    ImGui::Text("Shader startup (%s): %.1f ms", stats.shaderCache.compiled == 0 ? "warm" : "cold", stats.shaderCache.startupMs);
+    ImGui::Text("programs cached / compiled: %u / %u", stats.shaderCache.loaded, stats.shaderCache.compiled);
+    ImGui::Text("waiting on the driver:      %.1f ms", stats.shaderCache.waitMs);
+    ImGui::Separator();
+    ImGui::Text("Uniforms (last frame):");
+    ImGui::Text("by name set calls:        %u", stats.shaders.nameLookups);
+    ImGui::Text("glGetUniformLocation:     %u", stats.shaders.locationQueries);
+    ImGui::Text("glUniform* uploads:       %u", stats.shaders.uploads);
+    ImGui::Separator();
+    ImGui::Text("Render queue: %u packets in %u draws", stats.queue.packets, stats.queue.draws);
+    ImGui::Text("Geometry arena: %u / %u vertices, %u / %u indices", stats.verticesUsed, stats.vertexCapacity,
+                stats.indicesUsed, stats.indexCapacity);
+    ImGui::Separator();
+    ImGui::Text("State changes (last frame):");
+    ImGui::Text("issued:                   %u", stats.glState.issued);
+    ImGui::Text("filtered:                 %u", stats.glState.filtered);
 }
 
 void drawDeactivateFollowing() {
@@ -58,6 +58,7 @@ int main() {
 
     app->setupFunc();
     isLoading = false;
+    app->startRendering();
     while(app->running()) {
         if(!isLoading) {
             if (flag) {
@@ -66,9 +67,9 @@ int main() {
             }
             app->handleEvents();
             app->updateFunc();     
-            app->renderFunc();
         }
     }
+    app->stopRendering();
     app->clean();
 
     SDL_DetachThread(threadID);
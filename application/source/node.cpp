@@ -1,6 +1,8 @@
 #include "node.hpp"
 #include "sceneGraph.hpp"
 #include "utils.hpp"
+#include "procedural.hpp"
+#include "camera.hpp"
 
 #include <SDL.h>
 #define GLM_ENABLE_EXPERIMENTAL
@@ -13,8 +15,9 @@ float speedSlider = 1.0f;
 
 Node* foundNode;
 
-Node::Node(std::string aName, float aDistance, float aRotationSpeed, float aSize, float aSelfRotSpeed, std::string aTexturePath) {
+Node::Node(std::string aName, float aDistance, float aRotationSpeed, float aSize, float aSelfRotSpeed, std::string aTexturePath, BodyType aType) {
     name = aName;
+    type = aType;
     distanceFromOrigin = aDistance;
     rotationSpeed = aRotationSpeed;
     selfRotSpeed = aSelfRotSpeed;
@@ -77,28 +80,36 @@ void Node::setLocalTransform(glm::fmat4& mat) {
     localTransform = mat * localTransform; 
 }
 
-void Node::setWorldTransform(glm::fmat4& mat) {
+void Node::setWorldTransform(const glm::dmat4& mat) {
     timer = float(SDL_GetTicks()) / 1000.0f;
 
-    glm::fmat4 trans = glm::fmat4(1.0f);
+    glm::dmat4 trans = glm::dmat4(1.0);
 
-    static float rot, selfRot;
+    static double rot, selfRot;
+    // rot is the mean anomaly along the orbit, the body still turns with it as a whole
 
     if (isMoving) {
         rot = timer * rotationSpeed * speedSlider;
         selfRot = timer * selfRotSpeed * speedSlider;
-        trans = glm::rotate(trans, rot, glm::fvec3{0.0f, 1.0f, 0.0f});
-        trans = glm::translate(trans, glm::fvec3 {0.0f, 0.0f, distanceFromOrigin});    
-        trans = glm::rotate(trans, selfRot, glm::fvec3{0.0f, 1.0f, 0.0f}); // self rotation 
-        trans = glm::scale(trans, glm::fvec3 {size, size, size});
+        trans = glm::translate(trans, orbitPosition(getOrbit(), rot));
+        trans = glm::rotate(trans, rot, glm::dvec3{0.0, 1.0, 0.0});
+        trans = glm::rotate(trans, selfRot, glm::dvec3{0.0, 1.0, 0.0}); // self rotation 
+        trans = glm::scale(trans, glm::dvec3 {size, size, size});
     } else {
-        trans = glm::rotate(trans, rot, glm::fvec3{0.0f, 1.0f, 0.0f});
-        trans = glm::translate(trans, glm::fvec3 {0.0f, 0.0f, distanceFromOrigin});    
-        trans = glm::rotate(trans, selfRot, glm::fvec3{0.0f, 1.0f, 0.0f}); // self rotation 
-        trans = glm::scale(trans, glm::fvec3 {size, size, size});
+        trans = glm::translate(trans, orbitPosition(getOrbit(), rot));
+        trans = glm::rotate(trans, rot, glm::dvec3{0.0, 1.0, 0.0});
+        trans = glm::rotate(trans, selfRot, glm::dvec3{0.0, 1.0, 0.0}); // self rotation 
+        trans = glm::scale(trans, glm::dvec3 {size, size, size});
     }
     
-    worldTransform = mat * localTransform * trans;
+    // mat is the parent's orbital frame, its spin stays on its own model matrix
+    worldTransform = mat * glm::dmat4(localTransform) * trans;
+    renderTransform = Camera::get().toRender(worldTransform);
+
+    // the scale keeps the moon 0.6 units out, earth's day no longer turns its ellipse
+    double scale = glm::length(glm::dvec3(worldTransform[0]));
+    orbitalFrame = glm::translate(glm::dmat4(1.0), glm::dvec3(worldTransform[3]));
+    orbitalFrame = glm::scale(orbitalFrame, glm::dvec3(scale, scale, scale));
 }
 
 void Node::setTexture() {
@@ -120,10 +131,29 @@ void Node::setTexture() {
     for (const std::string& str : texturePaths) {
         Texture* ptr = new Texture();
         ptr->setTexturePath(str);
-        ptr->set2DTexture(GL_REPEAT, GL_LINEAR);
+        ptr->setCubeSphereTexture(GL_LINEAR);
         allTexVec.emplace_back(ptr);
     }
 
+    // no map supplied, synthesize a unique surface seeded by the body name
+    if (texturePaths.empty()) {
+        Texture* ptr = new Texture();
+        ptr->setProceduralTexture(proceduralSeed(name), 128, GL_LINEAR);
+        allTexVec.emplace_back(ptr);
+    }
+}
+
+void Node::setOrbit(float aEccentricity, float aInclination, float aAscendingNode, float aPeriapsis) {
+    orbit.eccentricity = aEccentricity;
+    orbit.inclination = aInclination;
+    orbit.ascendingNode = aAscendingNode;
+    orbit.periapsis = aPeriapsis;
+}
+
+OrbitalElements Node::getOrbit() {
+    OrbitalElements elements = orbit;
+    elements.semiMajorAxis = distanceFromOrigin;
+    return elements;
 }
 
 void Node::setVisibility(bool flag) {
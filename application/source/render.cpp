@@ -11,22 +11,26 @@
 
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 Node* sg = SceneGraph::get().getRoot();
 
 Shader sunShader("sun"); 
-Shader planetShader("planet"); 
-Shader earthShader("earth");  
+// feature lists are #defines, the variant bits below follow their order
+Shader planetShader("planet", {"OUTLINE", "PLANET_BLOOM"}); 
+Shader earthShader("earth", {"OUTLINE", "FLAT_MAP"});  
 Shader orbitShader("orbit");
 Shader starShader("stars");
 Shader skyboxShader("skybox");
-Shader quadShader("quad");
+Shader quadShader("quad", {"BLUR", "GRAYSCALE", "VERTICAL_MIRROR", "HORIZONTAL_MIRROR"});
 Shader blurShader("blur");
-Shader bloomShader("bloom");
+Shader bloomShader("bloom", {"BLOOM", "BLUR", "GRAYSCALE", "VERTICAL_MIRROR", "HORIZONTAL_MIRROR"});
 Shader sunBloomShader("sunBloom");
 Shader asteroidShader("asteroid");
 Shader ringShader("easy");
+Shader uiShader("ui");
 
 Model asteroid("rock.obj");
 Model sphere("sphere.obj");
@@ -34,11 +38,11 @@ Model cube("skybox.obj");
 Model quad("quad.obj");
 Model ring("planetring.obj");
 
-modelObject orbitModel;
-modelObject starModel;
-modelObject skyboxModel;
 
 Skybox skybox;
+// any HYG or Hipparcos csv saved under this name in resources/stars
+StarCatalogue starCatalogue;
+const char* starCatalogueName = "hygdata.csv";
 
 float shininess        = 11.9f;
 float ambient          = 0.04;
@@ -57,7 +61,9 @@ float glow             = 2.371f;
  bool verticalMirror   = false;
  bool horizontalMirror = false;
  bool orbits           = true;
+ bool beltOrbits       = false;
  bool stars            = true;
+float starMagnitude    = 7.0f;
  bool realism          = false;
  bool bloomFlag        = true;
  bool planetBloom      = true;
@@ -70,123 +76,514 @@ unsigned int pingpongFBO[2];
 unsigned int colorBuffers[2];
 unsigned int pingpongColorbuffers[2];
 unsigned int attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-unsigned int rboDepth;
+// a texture instead of a renderbuffer so the hi-z pyramid can read it
+unsigned int depthTexture;
+
+// uniform handles, resolved once after the programs are linked
+struct LitUniforms {
+    Uniform<int> texture1, texture2, texture3;
+};
+
+LitUniforms planetUniforms;
+LitUniforms earthUniforms;
+LitUniforms asteroidUniforms;
+Uniform<float> sunGlow;
+Uniform<int> sunTexture;
+Uniform<int> ringTexture;
+Uniform<int> skyboxTexture;
+Uniform<bool> blurHorizontal;
+Uniform<glm::fvec2> blurUvScale;
+Uniform<glm::fmat4> uiProjection;
+Uniform<int> uiTexture;
+
+struct StarUniforms {
+    Uniform<float> limit, pointScale;
+} starUniforms;
+
+struct BloomUniforms {
+    Uniform<int> bloomBlur;
+    Uniform<float> gamma, exposure;
+    Uniform<glm::fvec2> uvScale;
+    Uniform<float> sharpness;
+} bloomUniforms;
+
+LitUniforms resolveLitUniforms(Shader& shader) {
+    LitUniforms u;
+    u.texture1       = shader.getUniform<int>("texture1");
+    u.texture2       = shader.getUniform<int>("texture2");
+    u.texture3       = shader.getUniform<int>("texture3");
+    return u;
+}
+
+// gui toggles pick precompiled permutations instead of branching per fragment
+void selectVariants(const RenderSettings &s) {
+    planetShader.setVariant({ s.planetOutline, s.planetBloom });
+    earthShader.setVariant({ s.planetOutline, s.realism });
+    bloomShader.setVariant({ s.bloomFlag, s.blur, s.grayscale, s.verticalMirror, s.horizontalMirror });
+    quadShader.setVariant({ s.blur, s.grayscale, s.verticalMirror, s.horizontalMirror });
+}
+
+void resolveUniforms() {
+    planetUniforms   = resolveLitUniforms(planetShader);
+    earthUniforms    = resolveLitUniforms(earthShader);
+    asteroidUniforms = resolveLitUniforms(asteroidShader);
+
+    sunGlow        = sunBloomShader.getUniform<float>("glow");
+    sunTexture     = sunBloomShader.getUniform<int>("texture1");
+    ringTexture    = ringShader.getUniform<int>("texture1");
+    skyboxTexture  = skyboxShader.getUniform<int>("skybox");
+    blurHorizontal = blurShader.getUniform<bool>("horizontal");
+    blurUvScale    = blurShader.getUniform<glm::fvec2>("uvScale");
+    uiProjection   = uiShader.getUniform<glm::fmat4>("projection");
+    uiTexture      = uiShader.getUniform<int>("texture1");
+
+    starUniforms.limit      = starShader.getUniform<float>("limit");
+    starUniforms.pointScale = starShader.getUniform<float>("pointScale");
+
+    bloomUniforms.bloomBlur        = bloomShader.getUniform<int>("bloomBlur");
+    bloomUniforms.gamma            = bloomShader.getUniform<float>("gamma");
+    bloomUniforms.exposure         = bloomShader.getUniform<float>("exposure");
+    bloomUniforms.uvScale          = bloomShader.getUniform<glm::fvec2>("uvScale");
+    bloomUniforms.sharpness        = bloomShader.getUniform<float>("sharpness");
+}
+
+// camera and light, rewritten every frame
+StreamBuffer frameStream;
+
+// surface types, planets and earth follow the gui sliders, rocks keep fixed values
+Material planetMaterial;
+Material earthMaterial;
+Material asteroidMaterial;
 
 Texture ringTex("planets/saturnring.jpg");
 Texture asteroidTexture("rock.jpg");
-unsigned int amount = 1000;
-glm::mat4* modelMatrices;
+int asteroidCount = 1000;
+AsteroidBelt belt;
+// gpu culling of the belt when the context has a path for it
+InstanceCuller beltCuller;
+bool gpuCulling = true;
+bool beltOnGpu = false;
+// last frame's depth pyramid, bodies test against its readback and the gpu belt against the texture
+HiZ hiZ;
+bool occlusionCulling = true;
+
+// the scene is drawn into the corner of the full size targets, nothing is
+// reallocated when the scale moves; only the final composite and ImGui run native
+DynamicResolution dynamicResolution;
+GpuTimer frameTimer;
+bool dynamicRes = true;
+float targetFrameMs = 16.0f;
+float sharpness = 0.5f;
+glm::ivec2 sceneSize(screenWidth, screenHeight);
+// render space (camera at 0) for the scene graph, world space for the belt
+// whose instances are written in world coordinates
+Frustum viewFrustum;
+Frustum beltFrustum;
+Uint32 lastUpdateTicks = 0;
+unsigned long long lastFrameAllocations = 0;
+RenderQueue renderQueue;
+// every orbit in one draw; the belt's are a sample, its rocks are too many to trace
+OrbitRenderer orbitRenderer;
+const int maxBeltOrbits = 2000;
+
+TripleBuffer<FrameSnapshot> snapshots;
+TripleBuffer<RenderStats> renderStats;
+// the render thread's copy of the frame it is drawing
+RenderSettings settings;
+
+void copySettings(RenderSettings &s) {
+    s.shininess        = shininess;
+    s.ambient          = ambient;
+    s.lightIntensity   = lightIntensity;
+    s.reflectivity     = reflectivity;
+    s.lightConstant    = lightConstant;
+    s.lightLinear      = lightLinear;
+    s.lightQuadratic   = lightQuadratic;
+    s.exposure         = exposure;
+    s.gamma            = gamma;
+    s.glow             = glow;
+    s.sharpness        = sharpness;
+    s.targetFrameMs    = targetFrameMs;
+    s.speedSlider      = speedSlider;
+    s.asteroidCount    = asteroidCount;
+    s.planetOutline    = planetOutline;
+    s.planetBloom      = planetBloom;
+    s.blur             = blur;
+    s.grayscale        = grayscale;
+    s.verticalMirror   = verticalMirror;
+    s.horizontalMirror = horizontalMirror;
+    s.stars            = stars;
+    s.beltOrbits       = orbits && beltOrbits;
+    s.starMagnitude    = starMagnitude;
+    s.realism          = realism;
+    s.bloomFlag        = bloomFlag;
+    s.gpuCulling       = gpuCulling;
+    s.occlusionCulling = occlusionCulling;
+    s.dynamicRes       = dynamicRes;
+}
 
 void setup() {
-    // parse and compile shaders
-    sunShader.createShader();
-    planetShader.createShader();
-    orbitShader.createShader();
-    starShader.createShader();
-    earthShader.createShader();
-    skyboxShader.createShader();
-    quadShader.createShader();
-    blurShader.createShader();
-    bloomShader.createShader();
-    sunBloomShader.createShader();
-    asteroidShader.createShader();
-    ringShader.createShader();
+    // shaders get LOG_DEPTH from here when clip control is missing
+    initializeDepth();
+    // camera and light data is shared by all programs through one uniform block
+    Shader::registerBlock("FrameData", frameDataBinding);
+    frameStream.create(GL_UNIFORM_BUFFER, sizeof(FrameData));
+    Shader::registerBlock("Material", materialBinding);
+    Material::initialize(8);
+    Shader::registerBlock("Instances", instanceBinding);
+    renderQueue.initialize(Camera::get().nearPlane);
+    planetMaterial.create();
+    earthMaterial.create();
+    asteroidMaterial.create();
+    asteroidMaterial.update(MaterialData{ 32.0f, 0.1f, 0.5f });
+
+    // let the driver compile on its own threads, queried only on first use
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+
+    // submit all programs before the textures are decoded below, sources are
+    // compiled or restored from the program binary cache in the background
+    Uint64 shaderStart = SDL_GetPerformanceCounter();
+    RenderSettings initial;
+    copySettings(initial);
+    selectVariants(initial);
+    Shader* startupShaders[] = { &sunShader, &planetShader, &orbitShader, &starShader, &earthShader, &skyboxShader, &quadShader,
+                                 &blurShader, &bloomShader, &sunBloomShader, &asteroidShader, &ringShader, &uiShader };
+    for (Shader* shader : startupShaders) {
+        shader->createShader();
+    }
+    double submitMs = (SDL_GetPerformanceCounter() - shaderStart) * 1000.0 / SDL_GetPerformanceFrequency();
+    resolveUniforms();
     // setting geometries
     sphere.setGeometry(GL_TRIANGLES); 
     cube.setGeometry(GL_TRIANGLES); 
     quad.setGeometry(GL_TRIANGLES);
     asteroid.setGeometry(GL_TRIANGLES);
     ring.setGeometry(GL_TRIANGLES);
+    // queued draws bind the vao directly, so the layouts are described up front
+    sphere.setVertexAttributes();
+    quad.setVertexAttributes();
+    ring.setVertexAttributes();
     // initializing scene graph
     sg->setName("root");
                                       //dis  //rot //size //self
-    sg->addChild(new Node("sun",      0.0f,   0.0f, 1.0f, 0.5f, "planets/2k_sun.jpg"));
+    sg->addChild(new Node("sun",      0.0f,   0.0f, 1.0f, 0.5f, "planets/2k_sun.jpg", BODY_SUN));
     sg->addChild(new Node("mercury",  3.0f,  0.06f, 0.2f, 1.0f, "planets/2k_mercury.jpg"));
     sg->addChild(new Node("venus",    6.0f,  0.05f, 0.2f, 1.0f, "planets/2k_venus.jpg"));         
-    sg->addChild(new Node("earth",    9.0f, 0.038f, 0.3f, 2.4f, "planets/2k_earth.jpg,planets/2k_earth_clouds.jpg,planets/2k_earth_nightmap.jpg"));   
+    sg->addChild(new Node("earth",    9.0f, 0.038f, 0.3f, 2.4f, "planets/2k_earth.jpg,planets/2k_earth_clouds.jpg,planets/2k_earth_nightmap.jpg", BODY_EARTH));   
     sg->addChild(new Node("mars",    12.0f, 0.029f, 0.1f, 1.0f, "planets/2k_mars.jpg"));
     sg->addChild(new Node("jupiter", 15.0f, 0.022f, 0.7f, 1.0f, "planets/2k_jupiter.jpg"));
-    sg->addChild(new Node("saturn",  18.0f, 0.034f, 0.6f, 1.0f, "planets/2k_saturn.jpg"));
+    sg->addChild(new Node("saturn",  18.0f, 0.034f, 0.6f, 1.0f, "planets/2k_saturn.jpg", BODY_RINGED_PLANET));
     sg->addChild(new Node("uranus",  21.0f, 0.026f, 0.4f, 1.0f, "planets/2k_uranus.jpg"));
     sg->addChild(new Node("neptune", 24.0f, 0.028f, 0.4f, 1.0f, "planets/2k_neptune.jpg"));
     sg->addChild(new Node("pluto",   27.0f, 0.031f, 0.1f, 1.0f, "planets/plutomap.png"));
     sg->getChild("earth")->addChild(new Node("moon",     2.0f,   1.0f, 0.1f, 2.0f, "planets/2k_moon.jpg"));
+    // J2000 eccentricity, inclination, ascending node and argument of periapsis,
+    // the moon's against the ecliptic
+    sg->getChild("mercury")->setOrbit(0.2056f, glm::radians( 7.00f), glm::radians( 48.33f), glm::radians( 29.12f));
+    sg->getChild("venus")->setOrbit(  0.0068f, glm::radians( 3.39f), glm::radians( 76.68f), glm::radians( 54.88f));
+    sg->getChild("earth")->setOrbit(  0.0167f, glm::radians( 0.00f), glm::radians(  0.00f), glm::radians(102.94f));
+    sg->getChild("mars")->setOrbit(   0.0934f, glm::radians( 1.85f), glm::radians( 49.56f), glm::radians(286.50f));
+    sg->getChild("jupiter")->setOrbit(0.0489f, glm::radians( 1.30f), glm::radians(100.46f), glm::radians(273.87f));
+    sg->getChild("saturn")->setOrbit( 0.0565f, glm::radians( 2.49f), glm::radians(113.67f), glm::radians(339.39f));
+    sg->getChild("uranus")->setOrbit( 0.0457f, glm::radians( 0.77f), glm::radians( 74.01f), glm::radians( 96.99f));
+    sg->getChild("neptune")->setOrbit(0.0113f, glm::radians( 1.77f), glm::radians(131.78f), glm::radians(273.19f));
+    sg->getChild("pluto")->setOrbit(  0.2488f, glm::radians(17.16f), glm::radians(110.30f), glm::radians(113.83f));
+    sg->getChild("earth")->getChild("moon")->setOrbit(0.0549f, glm::radians( 5.15f), glm::radians(125.08f), glm::radians(318.15f));
 
     skybox.setPaths("milkyway/XP.jpg", "milkyway/XN.jpg", "milkyway/YP.jpg", "milkyway/YN.jpg", "milkyway/ZP.jpg", "milkyway/ZN.jpg");
 
-    initializeOrbits();
-    initializeStars(10000);
+    orbitRenderer.initialize();
+    starCatalogue.load(starCatalogueName);
     initializeAsteroids();
     initializeFramebuffer();
+    initializeUi();
+    hiZ.initialize(screenWidth, screenHeight);
+    frameTimer.initialize();
     //Framebuffer::get();
 
+    // planet textures are cube-spheres, filter across their face edges
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
     ringTex.setTexturePath("planets/saturnringcolor.jpg");
     ringTex.set2DTexture(GL_REPEAT, GL_LINEAR);
+
+    // the driver had the loads above to work in, whatever it still needs is
+    // startup time too; a rejected binary is recompiled in here, so the counts
+    // are only final afterwards
+    Uint64 completeStart = SDL_GetPerformanceCounter();
+    for (Shader* shader : startupShaders) {
+        shader->complete();
+    }
+    double completeMs = (SDL_GetPerformanceCounter() - completeStart) * 1000.0 / SDL_GetPerformanceFrequency();
+    shaderCacheStats.startupMs = submitMs + completeMs;
+    std::clog << "Shaders: ready in " << shaderCacheStats.startupMs << " ms (" << submitMs << " submitting), "
+              << (shaderCacheStats.compiled == 0 ? "warm" : "cold") << " start (" << shaderCacheStats.loaded << " cached, "
+              << shaderCacheStats.compiled << " compiled)" << std::endl;
 }
 
-void update() {
-    uploadView();
-    uploadProjection();
+void simulate(FrameSnapshot &frame) {
+    Camera& camera = Camera::get();
+    frame.ticks = SDL_GetTicks();
+    frame.camera.position = camera.position;
+    frame.camera.view = camera.getViewMatrix();
+    frame.camera.worldView = camera.getWorldViewMatrix();
+    frame.camera.projection = camera.getProjectionMatrix();
+    copySettings(frame.settings);
+
+    // the vector keeps its capacity from the last time this slot was written
+    frame.bodies.clear();
+    unsigned long long allocations = heapAllocations();
+    recursSimulate(*sg, frame.bodies);
+    frame.traversalAllocations = heapAllocations() - allocations;
+
+    frame.lightPosition = camera.toRender(glm::dvec3(sg->getLocalTransform()[3]));
+    frame.worldOrigin = camera.toRender(glm::dvec3(0.0));
 }
 
-void render() {
+void update(const FrameSnapshot &frame) {
+    settings = frame.settings;
+    lastShaderStats = shaderStats;
+    shaderStats = ShaderStats();
+    lastGLStateStats = glStateStats;
+    glStateStats = GLStateStats();
+    lastStreamStats = streamStats;
+    streamStats = StreamStats();
+    // before anything is written into a stream buffer this frame
+    FrameFences::get().beginFrame();
+
+    cullingStats = CullingStats();
+    hiZ.poll();
+    // gpu time, with vsync the cpu frame time would hide any headroom
+    double gpuMs = 0.0;
+    if (frameTimer.poll(gpuMs)) {
+        resolutionStats.gpuMs = gpuMs;
+        if (settings.dynamicRes) {
+            dynamicResolution.update(gpuMs, settings.targetFrameMs);
+        }
+    }
+    if (!settings.dynamicRes) {
+        dynamicResolution.reset();
+    }
+    // multiples of 8 keep the hi-z halvings on whole texels
+    glm::ivec2 screen(screenWidth, screenHeight);
+    sceneSize = glm::clamp(glm::ivec2(glm::fvec2(screen) * dynamicResolution.getScale()) / 8 * 8, glm::ivec2(8), screen);
+    resolutionStats.scale = dynamicResolution.getScale();
+    resolutionStats.width = sceneSize.x;
+    resolutionStats.height = sceneSize.y;
+    unsigned long long allocations = heapAllocations();
+    allocationStats.frame = allocations - lastFrameAllocations;
+    lastFrameAllocations = allocations;
+    allocationStats.traversal = frame.traversalAllocations;
+    viewFrustum.extract(frame.camera.projection * frame.camera.view);
+    beltFrustum.extract(frame.camera.projection * glm::fmat4(frame.camera.worldView));
+
+    if (settings.asteroidCount != belt.getCount()) {
+        belt.create(settings.asteroidCount, 13.5f);
+        beltCuller.resize(settings.asteroidCount);
+    }
+    // the instance attribute follows whichever buffer holds the visible rocks
+    bool cullOnGpu = settings.gpuCulling && beltCuller.getPath() != CULL_CPU;
+    if (cullOnGpu != beltOnGpu && cullOnGpu) {
+        asteroid.setInstanceBuffer(beltCuller.getOutput());
+    }
+    beltOnGpu = cullOnGpu;
+    // same time scale as the planets, which turn by ticks * speedSlider; the
+    // belt is propagated straight into its mapped buffer, so it stays on this thread
+    float dt = lastUpdateTicks == 0 ? 0.0f : (frame.ticks - lastUpdateTicks) / 1000.0f;
+    lastUpdateTicks = frame.ticks;
+    belt.update(dt * settings.speedSlider, beltFrustum, !beltOnGpu);
+    if (beltOnGpu) {
+        const MeshRange& rock = GeometryArena::get().getRange(asteroid.getModelObject().mesh);
+        beltCuller.cull(belt.getBuffer(), belt.getOffset(), belt.getCount(), beltFrustum, asteroid.getBoundingRadius(),
+                        rock, settings.occlusionCulling ? &hiZ : nullptr);
+        cullingStats.asteroidPath = beltCuller.getPathName();
+        cullingStats.asteroidOcclusion = beltCuller.hasRetest();
+    } else {
+        // streamed, the rocks sit at a new offset every frame
+        asteroid.setInstanceBuffer(belt.getBuffer(), belt.getOffset());
+        cullingStats.asteroidsVisible = belt.getVisibleCount();
+        cullingStats.asteroidsCulled = belt.getCount() - belt.getVisibleCount();
+    }
+
+    selectVariants(settings);
+    uploadFrameData(frame);
+    updateMaterials();
+}
+
+void render(const FrameSnapshot &frame) {
+    // setup and ImGui bind objects behind the state cache's back
+    GLState::get().invalidate();
+    GLState::get().viewport(0, 0, sceneSize.x, sceneSize.y);
+    GLState::get().depthFunc(GL_GREATER);
+    frameTimer.begin();
+
     glEnable(GL_DEPTH_TEST);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);   
 
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO); //Framebuffer::get().bind();
+    GLState::get().bindFramebuffer(hdrFBO); //Framebuffer::get().bind();
     {    
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        if (stars) {
-            drawStars();   
-        }
-
         drawAsteroid();
 
-        recursRender(*sg);
+        // bodies, rings and orbits are only queued, they are drawn sorted by state
+        renderQueue.clear(glm::fvec3(0.0f));
+        orbitRenderer.clear();
+        queueBodies(frame.bodies);
+        setQueuedProgramConstants();
+        renderQueue.submit();
+        drawOrbits(frame);
+
+        // this frame's depth, before the skybox, is next frame's occluder set;
+        // the rocks the belt held back against the old one get a second look
+        if (settings.occlusionCulling) {
+            hiZ.build(depthTexture, frame.camera.worldView, frame.camera.projection, sceneSize);
+            GLState::get().bindFramebuffer(hdrFBO);
+            GLState::get().viewport(0, 0, sceneSize.x, sceneSize.y);
+            if (beltOnGpu && beltCuller.hasRetest()) {
+                beltCuller.retest(hiZ, asteroid.getBoundingRadius());
+                drawAsteroid(true);
+            }
+        }
 
-        glDepthFunc(GL_LEQUAL);
+        // the skybox sits at depth 0, the cleared value, the stars on top of it
+        GLState::get().depthFunc(GL_GEQUAL);
         drawSkybox();  
-        glDepthFunc(GL_LESS); 
+        if (settings.stars) {
+            drawStars();
+        }
+        GLState::get().depthFunc(GL_GREATER); 
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0); //Framebuffer::get().unbind(); 
+    GLState::get().bindFramebuffer(0); //Framebuffer::get().unbind(); 
 
     drawFramebuffer(); 
+    frameTimer.end();
+    FrameFences::get().endFrame();
+}
+
+void publishRenderStats() {
+    RenderStats& stats = renderStats.back();
+    stats.culling = cullingStats;
+    stats.queue = renderQueueStats;
+    stats.allocations = allocationStats;
+    stats.shaders = lastShaderStats;
+    stats.shaderCache = shaderCacheStats;
+    stats.glState = lastGLStateStats;
+    stats.resolution = resolutionStats;
+    stats.streams = lastStreamStats;
+    stats.persistentStreams = StreamBuffer::isPersistent();
+    stats.orbits = orbitStats;
+    stats.stars = starStats;
+    stats.beltMs = belt.getUpdateMs();
+    const FreeList& vertexSpace = GeometryArena::get().getVertexSpace();
+    const FreeList& indexSpace = GeometryArena::get().getIndexSpace();
+    stats.verticesUsed = vertexSpace.getUsed();
+    stats.vertexCapacity = vertexSpace.getCapacity();
+    stats.indicesUsed = indexSpace.getUsed();
+    stats.indexCapacity = indexSpace.getCapacity();
+    renderStats.publish();
+}
+
+// world-space bounding sphere of a model drawn with transform against the view frustum
+bool isVisible(const glm::fmat4 &transform, float modelRadius) {
+    float radius = glm::length(glm::fvec3(transform[0])) * modelRadius;
+    return viewFrustum.testSphere(glm::fvec3(transform[3]), radius);
 }
 
-void recursRender(Node& it, glm::fmat4& mat) {    
+// bodies inside the frustum against the hi-z readback; it lags a frame or two,
+// so the sphere is padded and a body is only dropped once two tests in a row
+// agree, one stale result alone never hides it
+bool isOccluded(const BodySnapshot &body, float modelRadius) {
+    int& frames = body.node->getOccludedFrames();
+    if (!settings.occlusionCulling) {
+        frames = 0;
+        return false;
+    }
+    // world space, the readback was taken from wherever the camera was then
+    float radius = (float)glm::length(glm::dvec3(body.world[0])) * modelRadius * 1.1f;
+    frames = hiZ.occluded(glm::dvec3(body.world[3]), radius) ? frames + 1 : 0;
+    return frames >= 2;
+}
+
+// main thread, runs every frame, must not allocate (see allocationStats.traversal)
+void recursSimulate(Node& it, std::vector<BodySnapshot> &bodies, const glm::dmat4& mat) {    
     if (it.getVisibility()) {
-        if (it.getName() != sg->getName()) {
+        if (it.getType() != BODY_ROOT) {
             it.setWorldTransform(mat);
-            
-            if (it.getName() == "sun") {
-                drawSun(it);
-            } else {
-                if (it.getName() == "earth") {
-                    drawEarth(it);
-                } else {
-                    drawPlanet(it);  
-                    if (it.getName() == "saturn" && planetRing) {
-                        drawRing(it, mat);
-                    }
-                }
-                if (orbits) {
-                    drawOrbit(it, mat);
-                }
+            glm::fmat4 parent = Camera::get().toRender(mat);
+
+            BodySnapshot body;
+            body.node = &it;
+            body.type = it.getType();
+            body.world = it.getWorldTransform();
+            body.render = it.getRenderTransform();
+            // rings reach past the planet, they get their own sphere around its centre
+            body.ring = it.getType() == BODY_RINGED_PLANET && planetRing;
+            if (body.ring) {
+                body.ringModel = Camera::get().toRender(ringTransform(it, mat, float(SDL_GetTicks()) / 1000.0f));
+                body.ringBounds = body.render;
+                body.ringBounds[0] = parent[0] * 1.3f;
+            }
+            // the ellipse lies in the parent's orbital frame, as the body does
+            body.orbit = it.getType() != BODY_SUN && orbits;
+            if (body.orbit) {
+                OrbitalElements elements = it.getOrbit();
+                glm::dmat4 frame = mat * glm::dmat4(it.getLocalTransform());
+                glm::dvec3 p, q;
+                orbitAxes(elements, p, q);
+                body.orbitPath.focus = Camera::get().toRender(glm::dvec3(frame[3]));
+                body.orbitPath.p = glm::fvec3(glm::dmat3(frame) * p);
+                body.orbitPath.q = glm::fvec3(glm::dmat3(frame) * q);
+                body.orbitPath.eccentricity = (float)elements.eccentricity;
             }
+            bodies.push_back(body);
         }
 
         if (!it.getChildrenList().empty()) {
 
             for (Node* itChild : it.getChildrenList()) {
-                Node ptr = *itChild;
-                recursRender(*itChild, it.getWorldTransform());
+                recursSimulate(*itChild, bodies, it.getOrbitalFrame());
             }
         }
     }
 }
 
+// render thread, culls the snapshot's bodies and queues what is left
+void queueBodies(const std::vector<BodySnapshot> &bodies) {
+    for (const BodySnapshot& body : bodies) {
+        bool visible = isVisible(body.render, sphere.getBoundingRadius());
+        if (!visible) {
+            cullingStats.nodesCulled++;
+        } else if (isOccluded(body, sphere.getBoundingRadius())) {
+            // rings and orbits reach past the body, they keep their own tests
+            cullingStats.nodesOccluded++;
+            visible = false;
+        } else {
+            cullingStats.nodesVisible++;
+        }
+
+        if (visible) {
+            if (body.type == BODY_SUN) {
+                queueSun(body);
+            } else if (body.type == BODY_EARTH) {
+                queueEarth(body);
+            } else {
+                queuePlanet(body);
+            }
+        }
+        if (body.ring && isVisible(body.ringBounds, ring.getBoundingRadius())) {
+            queueRing(body);
+        }
+        // culled with the rest in drawOrbits
+        if (body.orbit) {
+            orbitRenderer.push(body.orbitPath);
+        }
+    }
+}
+
 void initializeFramebuffer() {
     
     glGenFramebuffers(1, &hdrFBO);
@@ -204,11 +601,15 @@ void initializeFramebuffer() {
         // attach texture to framebuffer
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, colorBuffers[i], 0);
     }
-    // create and attach depth buffer (renderbuffer)
-    glGenRenderbuffers(1, &rboDepth); 
-    glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, screenWidth, screenHeight);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
+    // create and attach depth buffer, sampled by the hi-z reduction
+    glGenTextures(1, &depthTexture);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, screenWidth, screenHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
     // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
     glDrawBuffers(2, attachments);
     // finally check if framebuffer is complete
@@ -246,101 +647,57 @@ void initializeAsteroids() {
     asteroidTexture.setTexturePath("rock.jpg");
     asteroidTexture.set2DTexture(GL_REPEAT, GL_LINEAR);
 
-    modelMatrices = new glm::mat4[amount];
-    srand(SDL_GetTicks()); // initialize random seed	
-    float radius = 13.5f;
-    float offset = 0.5f;
-    for (unsigned int i = 0; i < amount; i++) {
-        glm::mat4 model = glm::mat4(1.0f);
-        // 1. translation: displace along circle with 'radius' in range [-offset, offset]
-        float angle = (float)i / (float)amount * 360.0f;
-        float displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
-        float x = sin(angle) * radius + displacement;
-        displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
-        float y = displacement * 0.4f; // keep height of asteroid field smaller compared to width of x and z
-        displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
-        float z = cos(angle) * radius + displacement;
-        model = glm::translate(model, glm::vec3(x, y, z));
-
-        // 2. scale: Scale between 0.05 and 0.25f
-        float scale = (rand() % 2) / 100.0f + 0.01;
-        model = glm::scale(model, glm::vec3(scale));
-
-        // 3. rotation: add random rotation around a (semi)randomly picked rotation axis vector
-        float rotAngle = (rand() % 360);
-        model = glm::rotate(model, rotAngle, glm::vec3(0.4f, 0.6f, 0.8f));
-
-        // 4. now add to list of matrices
-        modelMatrices[i] = model;
-    }
-}
-
-void initializeStars(unsigned int amount) {
-    std::vector<GLfloat> starVec;
-    for (unsigned int i = 0; i < amount; ++i) {
-        starVec.push_back(static_cast<GLfloat> (rand() % 200 + 1) - 100);
-    }
+    belt.setMeshRadius(asteroid.getBoundingRadius());
+    belt.create(asteroidCount, 13.5f);
+    asteroid.setVertexAttributes();
+    asteroid.setInstanceBuffer(belt.getBuffer());
 
-    glGenVertexArrays(1, &starModel.VAO);
-    glBindVertexArray(starModel.VAO);
-
-    glGenBuffers(1, &starModel.VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, starModel.VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * starVec.size(), starVec.data(), GL_STATIC_DRAW);
-
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_TRUE, 3 * sizeof(float), (void*)0);
-
-    glGenBuffers(1, &starModel.EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, starModel.EBO);
-
-    starModel.draw_mode = GL_POINTS;
-    starModel.num_elements = GLsizei(starVec.size());
+    beltCuller.initialize(InstanceCuller::detect());
+    beltCuller.resize(asteroidCount);
 }
 
-void initializeOrbits() {
-    std::vector<GLfloat> orbitVec;
-
-    for (unsigned int i = 0; i < 361; i++){
-        orbitVec.push_back(static_cast<GLfloat>(cos((i * M_PI)/180))); 
-        orbitVec.push_back(static_cast<GLfloat>(-sin((i * M_PI)/180)));
-    }
-    
-    glGenVertexArrays(1, &orbitModel.VAO);
-    glBindVertexArray(orbitModel.VAO);
-
-    glGenBuffers(1, &orbitModel.VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, orbitModel.VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * orbitVec.size(), orbitVec.data(), GL_STATIC_DRAW);
-
+// ImGui vertices and indices, refilled from the snapshot every frame
+GLuint uiVAO = 0;
+GLuint uiVBO = 0;
+GLuint uiEBO = 0;
+
+void initializeUi() {
+    glGenVertexArrays(1, &uiVAO);
+    glGenBuffers(1, &uiVBO);
+    glGenBuffers(1, &uiEBO);
+    GLState::get().bindVertexArray(uiVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, uiVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, uiEBO);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)(1 * sizeof(float)));
-    
-    glGenBuffers(1, &orbitModel.EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, orbitModel.EBO);
-
-    orbitModel.draw_mode = GL_LINE_LOOP;
-    orbitModel.num_elements = GLsizei(orbitVec.size() / 2);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (void*)IM_OFFSETOF(ImDrawVert, pos));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert), (void*)IM_OFFSETOF(ImDrawVert, uv));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (void*)IM_OFFSETOF(ImDrawVert, col));
+    GLState::get().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void drawFramebuffer() {
+    // fullscreen quads at z = 0 would fail GL_GREATER against the cleared 0
+    glDisable(GL_DEPTH_TEST);
     bloomShader.use();
-    bloomShader.setInt("bloomBlur", 1);
-    bloomShader.setBool("bloomFlag", bloomFlag);
+    bloomShader.set(bloomUniforms.bloomBlur, 1);
+
+    glm::fvec2 uvScale = glm::fvec2(sceneSize) / glm::fvec2(screenWidth, screenHeight);
 
     bool horizontal = true, first_iteration = true;
     unsigned int amount = 10;
     blurShader.use();
+    blurShader.set(blurUvScale, uvScale);
     
     for (unsigned int i = 0; i < amount; i++) {
-        glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[horizontal]);
+        GLState::get().bindFramebuffer(pingpongFBO[horizontal]);
         //glBindFramebuffer(GL_FRAMEBUFFER, Framebuffer::get().getpingpongFBO(horizontal));
         
-        blurShader.setInt("horizontal", horizontal);
+        blurShader.set(blurHorizontal, horizontal);
 
-        glBindTexture(GL_TEXTURE_2D, first_iteration ? colorBuffers[1] : pingpongColorbuffers[!horizontal]); 
+        GLState::get().bindTexture(0, GL_TEXTURE_2D, first_iteration ? colorBuffers[1] : pingpongColorbuffers[!horizontal]); 
         //glBindTexture(GL_TEXTURE_2D, first_iteration ? Framebuffer::get().getcolorBuffers(1) : Framebuffer::get().getpingpongColorBuffers(!horizontal)); 
 
         renderQuad();
@@ -348,25 +705,23 @@ void drawFramebuffer() {
         if (first_iteration)
             first_iteration = false;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bindFramebuffer(0);
+    // the upscale to the window
+    GLState::get().viewport(0, 0, screenWidth, screenHeight);
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     bloomShader.use();
     
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
+    GLState::get().bindTexture(0, GL_TEXTURE_2D, colorBuffers[0]);
     //glBindTexture(GL_TEXTURE_2D, Framebuffer::get().getcolorBuffers(0));
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[!horizontal]); 
+    GLState::get().bindTexture(1, GL_TEXTURE_2D, pingpongColorbuffers[!horizontal]); 
     //glBindTexture(GL_TEXTURE_2D, Framebuffer::get().getpingpongColorBuffers(!horizontal));
 
-    bloomShader.setFloat("gamma", gamma);
-    bloomShader.setBool("blur", blur);
-    bloomShader.setBool("grayscale", grayscale);
-    bloomShader.setBool("verticalMirror", verticalMirror);
-    bloomShader.setBool("horizontalMirror", horizontalMirror);
-    bloomShader.setFloat("exposure", exposure);
+    bloomShader.set(bloomUniforms.gamma, settings.gamma);
+    bloomShader.set(bloomUniforms.exposure, settings.exposure);
+    bloomShader.set(bloomUniforms.uvScale, uvScale);
+    bloomShader.set(bloomUniforms.sharpness, uvScale.x < 1.0f ? settings.sharpness : 0.0f);
     renderQuad();
 }
 
@@ -377,203 +732,178 @@ void renderQuad() {
 
 void drawQuad() {
     quadShader.use();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, Framebuffer::get().getTextureID());
+    GLState::get().bindTexture(0, GL_TEXTURE_2D, Framebuffer::get().getTextureID());
     quadShader.setInt("texture1", 0);
 
-    quadShader.setBool("blur", blur);
-    quadShader.setBool("grayscale", grayscale);
-    quadShader.setBool("verticalMirror", verticalMirror);
-    quadShader.setBool("horizontalMirror", horizontalMirror);
-    quadShader.setFloat("exposure", exposure);
-    quadShader.setFloat("gamma", gamma);
+    quadShader.setFloat("exposure", settings.exposure);
+    quadShader.setFloat("gamma", settings.gamma);
 
     quad.setVertexAttributes();
     quad.draw();
 }
 
-void drawRing(Node& it, glm::fmat4 &mat) {
-    float timer = float(SDL_GetTicks()) / 1000.0f;
-    ringShader.use();
-    glm::fmat4 model = mat;
-    float rot = timer * it.getRotationSpeed() * speedSlider;
-    float selfRot = timer * it.getSelfRotSpeed() * speedSlider;
-    model = glm::rotate(model, rot, glm::fvec3{0.0f, 1.0f, 0.0f});
-    model = glm::translate(model, glm::fvec3 {0.0f, 0.0f, it.getDistanceFromOrigin()});
-    model = glm::rotate(model, selfRot, glm::fvec3{0.0f, 1.0f, 0.0f}); 
-    model = glm::scale(model, glm::vec3(1.3f, 1.3f, 1.3f));
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ringTex.getID());
-    ringShader.setInt("texture1", 0);
-    
-    ringShader.setModel(model);
-    ring.setVertexAttributes();
-    ring.draw();
+glm::dmat4 ringTransform(Node& it, const glm::dmat4 &mat, float timer) {
+    glm::dmat4 model = mat;
+    double rot = timer * it.getRotationSpeed() * speedSlider;
+    double selfRot = timer * it.getSelfRotSpeed() * speedSlider;
+    model = glm::translate(model, orbitPosition(it.getOrbit(), rot));
+    model = glm::rotate(model, rot, glm::dvec3{0.0, 1.0, 0.0});
+    model = glm::rotate(model, selfRot, glm::dvec3{0.0, 1.0, 0.0}); 
+    model = glm::scale(model, glm::dvec3(1.3, 1.3, 1.3));
+    return model;
 }
 
-void drawOrbit(Node& it, glm::fmat4 &mat) {
-    orbitShader.use();
-
-    glm::vec3 origin;
-    glm::fmat4 root;
-
-    glm::fmat4 model_matrix = mat;
-
-    root = it.getParent()->getLocalTransform();
-    
-    origin[0] = root[3][0];
-    origin[1] = root[3][1];
-    origin[2] = root[3][2];
+void queueRing(const BodySnapshot &body) {
+    Texture* textures[] = { &ringTex };
+    renderQueue.push(PASS_OPAQUE, ringShader, nullptr, ring.getModelObject(), body.ringModel, textures, 1);
+}
 
-    glm::vec3 scale_dir(it.getDistanceFromOrigin(), it.getDistanceFromOrigin(), it.getDistanceFromOrigin());
-    model_matrix = glm::translate(model_matrix, origin);
-    model_matrix = glm::scale(model_matrix, scale_dir);
-    
-    orbitShader.setModel(model_matrix);
-    
-    glBindVertexArray(orbitModel.VAO);
-    glDrawArrays(orbitModel.draw_mode, 0, orbitModel.num_elements); 
-    glBindVertexArray(0);
+// the planets' orbits came in with queueBodies, a sample of the belt joins them
+void drawOrbits(const FrameSnapshot &frame) {
+    if (settings.beltOrbits) {
+        int count = std::min(belt.getCount(), maxBeltOrbits);
+        for (int i = 0; i < count; i++) {
+            orbitRenderer.push(belt.getOrbit(i, frame.worldOrigin));
+        }
+    }
+    // pixels per unit at distance 1 in the viewport the scene is drawn to
+    float pixelScale = frame.camera.projection[1][1] * 0.5f * sceneSize.y;
+    orbitRenderer.draw(orbitShader, viewFrustum, pixelScale);
 }
 
+// additive sprites at infinity, only where nothing but the skybox was drawn
 void drawStars() {
     starShader.use();
-    starShader.setModel();
-    glBindVertexArray(starModel.VAO);
-    glDrawArrays(starModel.draw_mode, 0, starModel.num_elements);
+    starShader.set(starUniforms.limit, settings.starMagnitude);
+    starShader.set(starUniforms.pointScale, (float)sceneSize.y / screenHeight);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    starCatalogue.draw(settings.starMagnitude);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
 }
 
-void drawPlanet(Node& it) {
-    planetShader.use();
+void queuePlanet(const BodySnapshot &body) {
+    std::vector<Texture*>& textures = body.node->getTextureList();
+    renderQueue.push(PASS_OPAQUE, planetShader, &planetMaterial, sphere.getModelObject(), body.render,
+                     textures.data(), (int)textures.size());
+}
 
-    if (it.getTexturePath() != "") {     
-        planetShader.setInt("texture1", 0);
-        glActiveTexture(GL_TEXTURE0);
-        it.getTextureList().at(0)->bind();
+void drawAsteroid(bool retested) {
+    float timer = float(SDL_GetTicks()) / 1000.0f;
+    asteroidShader.use();
+    asteroidMaterial.bind();
+    asteroidShader.set(asteroidUniforms.texture1, 0);
+    asteroidTexture.bind(0);
+
+    // the whole belt in one draw, matrices come from the instance buffer
+    asteroid.setVertexAttributes();
+    if (retested) {
+        asteroid.indirectDraw(beltCuller.getCommands(), beltCuller.getRetestOffset());
+    } else if (beltOnGpu) {
+        asteroid.indirectDraw(beltCuller.getCommands());
+    } else {
+        asteroid.instanceDraw(belt.getVisibleCount());
     }
+}
 
-    glm::fmat4 model_matrix = it.getWorldTransform();
-    planetShader.setModel(model_matrix);
-    planetShader.setfVec3("LightPosition", sg->getLocalTransform()[3][0], sg->getLocalTransform()[3][1], sg->getLocalTransform()[3][2]);
-    planetShader.setfVec3("LightColor", 0.0f, 0.0f, 0.0f);
-    planetShader.setFloat("Shininess", shininess);
-    planetShader.setFloat("AmbientVal", ambient);
-    planetShader.setFloat("LightIntensity", lightIntensity);
-    planetShader.setFloat("Reflectivity", reflectivity);    
-    planetShader.setBool("outline", planetOutline);
-    planetShader.setBool("planetBloom", planetBloom);
-    planetShader.setFloat("LightConstant", lightConstant);
-    planetShader.setFloat("LightLinear", lightLinear);
-    planetShader.setFloat("LightQuadratic", lightQuadratic);
-    planetShader.setfVec3("viewPos", Camera::get().position);
+void queueEarth(const BodySnapshot &body) {
+    const modelObject& mesh = settings.realism ? quad.getModelObject() : sphere.getModelObject();
+    std::vector<Texture*>& textures = body.node->getTextureList();
+    renderQueue.push(PASS_OPAQUE, earthShader, &earthMaterial, mesh, body.render, textures.data(), (int)textures.size());
+}
 
-    sphere.setVertexAttributes();
-    sphere.draw();    
+void queueSun(const BodySnapshot &body) {
+    std::vector<Texture*>& textures = body.node->getTextureList();
+    renderQueue.push(PASS_OPAQUE, sunBloomShader, nullptr, sphere.getModelObject(), body.render,
+                     textures.data(), (int)textures.size());
 }
 
-void drawAsteroid() {
-    float timer = float(SDL_GetTicks()) / 1000.0f;
-    for (unsigned int i = 0; i < amount; i++)
-    {
-        asteroidShader.use();
+// sampler units and the glow factor are program state, set once per frame
+// here instead of once per body
+void setQueuedProgramConstants() {
+    planetShader.use();
+    planetShader.set(planetUniforms.texture1, 0);
 
-        asteroidShader.setInt("texture1", 0);
-        glActiveTexture(GL_TEXTURE0);
-        asteroidTexture.bind();
+    earthShader.use();
+    earthShader.set(earthUniforms.texture1, 0);
+    earthShader.set(earthUniforms.texture2, 1);
+    earthShader.set(earthUniforms.texture3, 2);
 
-        asteroidShader.setModel(modelMatrices[i]);
-        asteroidShader.setfVec3("lightPosition", sg->getLocalTransform()[3][0], sg->getLocalTransform()[3][1], sg->getLocalTransform()[3][2]);
-        asteroidShader.setfVec3("lightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        asteroidShader.setfVec3("viewPos", Camera::get().position);
+    sunBloomShader.use();
+    sunBloomShader.set(sunTexture, 0);
+    sunBloomShader.set(sunGlow, settings.glow);
 
-        asteroid.setVertexAttributes();
-        asteroid.draw(); 
-        //asteroid.instanceDraw(amount); 
-    }    
+    ringShader.use();
+    ringShader.set(ringTexture, 0);
 }
 
-void drawEarth(Node& it) {
-    earthShader.use();
-    
-    if (it.getTexturePath() != "") { 
-        switch (it.getTextureList().size()) {
-        case 1: 
-            earthShader.setInt("texture1", 0);
-            glActiveTexture(GL_TEXTURE0);
-            it.getTextureList().at(0)->bind();
-        break;
-        case 2:
-            earthShader.setInt("texture1", 0);
-            earthShader.setInt("texture2", 1);
-            glActiveTexture(GL_TEXTURE0);
-            it.getTextureList().at(0)->bind();
-            glActiveTexture(GL_TEXTURE1);
-            it.getTextureList().at(1)->bind();
-        break;
-        case 3:
-            earthShader.setInt("texture1", 0);
-            earthShader.setInt("texture2", 1);
-            earthShader.setInt("texture3", 2);
-            glActiveTexture(GL_TEXTURE0);
-            it.getTextureList().at(0)->bind();
-            glActiveTexture(GL_TEXTURE1);
-            it.getTextureList().at(1)->bind();
-            glActiveTexture(GL_TEXTURE2);
-            it.getTextureList().at(2)->bind();
-        }
+// what ImGui_ImplOpenGL3_RenderDrawData does, with the scale from the snapshot
+void drawUi(const UiSnapshot &ui) {
+    const ImDrawData* data = ui.getDrawData();
+    ImVec2 scale = ui.getFramebufferScale();
+    int width = (int)(data->DisplaySize.x * scale.x);
+    int height = (int)(data->DisplaySize.y * scale.y);
+    if (width <= 0 || height <= 0) {
+        return;
     }
-    
-    glm::fmat4 model_matrix = it.getWorldTransform();
-    earthShader.setModel(model_matrix);
-    earthShader.setfVec3("LightPosition", sg->getLocalTransform()[3][0], sg->getLocalTransform()[3][1], sg->getLocalTransform()[3][2]);
-    earthShader.setfVec3("LightColor", 0.0f, 0.0f, 0.0f);
-    earthShader.setFloat("Shininess", shininess);
-    earthShader.setFloat("AmbientVal", ambient);
-    earthShader.setFloat("LightIntensity", lightIntensity);
-    earthShader.setFloat("Reflectivity", reflectivity);    
-    earthShader.setBool("outline", planetOutline);
-    earthShader.setFloat("LightConstant", lightConstant);
-    earthShader.setFloat("LightLinear", lightLinear);
-    earthShader.setFloat("LightQuadratic", lightQuadratic);
-    earthShader.setfVec3("viewPos", Camera::get().position);
-
-    if (realism) {
-        quad.setVertexAttributes();
-        quad.draw(); 
-    } else {
-        sphere.setVertexAttributes();
-        sphere.draw();  
-    }          
-}
 
-void drawSun(Node& it) {
-    glm::fmat4 model_matrix = it.getWorldTransform();
-
-    sunBloomShader.use();
-    sunBloomShader.setfMat4("model", model_matrix);
-    sunBloomShader.setFloat("glow", glow);
-
-    if (it.getTexturePath() != "") {
-        sunBloomShader.setInt("texture1", 0);
-        glActiveTexture(GL_TEXTURE0);
-        it.getTextureList().at(0)->bind();
-    } else {
-        std::cerr << "ERROR::TEXTURE::NOT DEFINED FOR \"" << it.getName() << "\"" << std::endl;
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_SCISSOR_TEST);
+    GLState::get().viewport(0, 0, width, height);
+
+    float L = data->DisplayPos.x;
+    float R = data->DisplayPos.x + data->DisplaySize.x;
+    float T = data->DisplayPos.y;
+    float B = data->DisplayPos.y + data->DisplaySize.y;
+    glm::fmat4 projection = glm::ortho(L, R, B, T);
+    uiShader.use();
+    uiShader.set(uiProjection, projection);
+    uiShader.set(uiTexture, 0);
+    GLState::get().bindVertexArray(uiVAO);
+
+    // clip rects were scaled on the main thread, the display position was not
+    ImVec2 origin(data->DisplayPos.x * scale.x, data->DisplayPos.y * scale.y);
+    for (int n = 0; n < data->CmdListsCount; n++) {
+        const ImDrawList* list = data->CmdLists[n];
+        glBindBuffer(GL_ARRAY_BUFFER, uiVBO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)list->VtxBuffer.Size * sizeof(ImDrawVert), list->VtxBuffer.Data, GL_STREAM_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)list->IdxBuffer.Size * sizeof(ImDrawIdx), list->IdxBuffer.Data, GL_STREAM_DRAW);
+
+        size_t offset = 0;
+        for (const ImDrawCmd& cmd : list->CmdBuffer) {
+            // callbacks run ImGui code, the menus do not add any
+            if (!cmd.UserCallback) {
+                ImVec4 clip(cmd.ClipRect.x - origin.x, cmd.ClipRect.y - origin.y, cmd.ClipRect.z - origin.x, cmd.ClipRect.w - origin.y);
+                if (clip.x < width && clip.y < height && clip.z >= 0.0f && clip.w >= 0.0f) {
+                    glScissor((int)clip.x, (int)(height - clip.w), (int)(clip.z - clip.x), (int)(clip.w - clip.y));
+                    GLState::get().bindTexture(0, GL_TEXTURE_2D, (GLuint)(intptr_t)cmd.TextureId);
+                    glDrawElements(GL_TRIANGLES, (GLsizei)cmd.ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                                   (void*)(offset * sizeof(ImDrawIdx)));
+                }
+            }
+            offset += cmd.ElemCount;
+        }
     }
-    sphere.setVertexAttributes();
-    sphere.draw();
-    
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisable(GL_SCISSOR_TEST);
+    glDisable(GL_BLEND);
 }
 
 void drawSkybox() {
     skyboxShader.use();
 
-    skyboxShader.setInt("skybox", 0);
+    skyboxShader.set(skyboxTexture, 0);
     skybox.bind();
 
     glm::fmat4 model_matrix = glm::fmat4(1.0f);
-    model_matrix = glm::translate(model_matrix, Camera::get().position);
     model_matrix = glm::scale(model_matrix, glm::vec3(100.0f, 100.0f, 100.0f));
     skyboxShader.setModel(model_matrix);
 
@@ -581,30 +911,35 @@ void drawSkybox() {
     cube.draw();
 }
 
-void uploadView() {
-    glm::mat4 view = Camera::get().getViewMatrix();
-    sunShader.setView(view);
-    earthShader.setView(view);
-    planetShader.setView(view);
-    starShader.setView(view);
-    skyboxShader.setView(view);
-    orbitShader.setView(view);
-    sunBloomShader.setView(view);
-    asteroidShader.setView(view);
-    ringShader.setView(view);
+// camera and light for every program, into this frame's slice of the stream
+void uploadFrameData(const FrameSnapshot &frame) {
+    FrameData data = {};
+    data.view           = frame.camera.view;
+    data.projection     = frame.camera.projection;
+    // render space, the camera is the origin
+    data.viewPos        = glm::fvec3(0.0f);
+    data.lightPosition  = frame.lightPosition;
+    data.worldOrigin    = frame.worldOrigin;
+    data.lightIntensity = settings.lightIntensity;
+    data.lightConstant  = settings.lightConstant;
+    data.lightLinear    = settings.lightLinear;
+    data.lightQuadratic = settings.lightQuadratic;
+    GLintptr offset = 0;
+    void* mapped = frameStream.map(sizeof(FrameData), offset);
+    if (!mapped) {
+        return;
+    }
+    std::memcpy(mapped, &data, sizeof(FrameData));
+    frameStream.unmap();
+    GLState::get().bindBufferRange(frameDataBinding, frameStream.getID(), offset, sizeof(FrameData));
 }
 
-void uploadProjection() {
-    glm::mat4 projection = Camera::get().getProjectionMatrix();
-    sunShader.setProjection(projection);
-    earthShader.setProjection(projection);
-    planetShader.setProjection(projection);
-    starShader.setProjection(projection);
-    skyboxShader.setProjection(projection);
-    orbitShader.setProjection(projection);
-    sunBloomShader.setProjection(projection);
-    asteroidShader.setProjection(projection);
-    ringShader.setProjection(projection);
+// re-uploads a material range only when a slider moved
+void updateMaterials() {
+    MaterialData data;
+    data.shininess    = settings.shininess;
+    data.ambient      = settings.ambient;
+    data.reflectivity = settings.reflectivity;
+    planetMaterial.update(data);
+    earthMaterial.update(data);
 }
-
-
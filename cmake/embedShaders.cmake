@@ -0,0 +1,52 @@
+# turns every shader stage and include under SHADER_DIR into a constexpr table in OUTPUT
+# usage: cmake -DSHADER_DIR=<dir> -DOUTPUT=<header> -P embedShaders.cmake
+
+if (NOT SHADER_DIR OR NOT OUTPUT)
+    message(FATAL_ERROR "embedShaders: SHADER_DIR and OUTPUT are required")
+endif()
+
+file(GLOB_RECURSE SHADER_FILES RELATIVE ${SHADER_DIR}
+    "${SHADER_DIR}/*.vert"
+    "${SHADER_DIR}/*.frag"
+    "${SHADER_DIR}/*.geom"
+    "${SHADER_DIR}/*.comp"
+    "${SHADER_DIR}/*.glsl"
+)
+list(SORT SHADER_FILES)
+
+set(CONTENT "// generated by cmake/embedShaders.cmake from resources/shaders, do not edit\n")
+string(APPEND CONTENT "#ifndef EMBEDDEDSHADERS_HPP\n#define EMBEDDEDSHADERS_HPP\n\n")
+string(APPEND CONTENT "struct EmbeddedShader {\n    const char* name;\n    const char* source;\n};\n\n")
+string(APPEND CONTENT "constexpr EmbeddedShader embeddedShaders[] = {\n")
+
+foreach(SHADER ${SHADER_FILES})
+    file(READ "${SHADER_DIR}/${SHADER}" SOURCE)
+    string(FIND "${SOURCE}" ")shader\"" CLASH)
+    if (NOT CLASH EQUAL -1)
+        message(FATAL_ERROR "embedShaders: ${SHADER} contains the raw string delimiter")
+    endif()
+
+    # msvc caps a single string literal, so long files become adjacent pieces
+    string(APPEND CONTENT "    { \"${SHADER}\",\n")
+    string(LENGTH "${SOURCE}" LENGTH)
+    set(OFFSET 0)
+    while (OFFSET LESS LENGTH)
+        string(SUBSTRING "${SOURCE}" ${OFFSET} 8000 PIECE)
+        string(APPEND CONTENT "      R\"shader(${PIECE})shader\"\n")
+        math(EXPR OFFSET "${OFFSET} + 8000")
+    endwhile()
+    if (LENGTH EQUAL 0)
+        string(APPEND CONTENT "      \"\"\n")
+    endif()
+    string(APPEND CONTENT "    },\n")
+endforeach()
+
+string(APPEND CONTENT "};\n\n#endif\n")
+
+# only touch the header when something changed so dependents do not rebuild
+if (EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if (NOT "${CONTENT}" STREQUAL "${PREVIOUS}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
@@ -0,0 +1,15 @@
+#ifndef ALLOCATIONS_HPP
+#define ALLOCATIONS_HPP
+
+// the global operator new is replaced to count heap allocations, a relaxed
+// atomic increment so it stays on in release builds
+unsigned long long heapAllocations();
+
+struct AllocationStats {
+    unsigned long long frame = 0;     // from one update() to the next, all threads
+    unsigned long long traversal = 0; // inside recursSimulate, should stay 0
+};
+
+extern AllocationStats allocationStats;
+
+#endif
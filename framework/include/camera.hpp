@@ -3,6 +3,7 @@
 
 #include "glewInc.hpp"
 #include "utils.hpp"
+#include "reversedZ.hpp"
 #include <SDL.h>
 
 #include <glm/glm.hpp>
@@ -22,7 +23,8 @@ enum f_Camera {
 class Camera {
 
 public:
-    glm::vec3 position = glm::vec3(0.0f, 0.0f, 3.0f);
+    // double so it stays exact far from the sun, see toRender
+    glm::dvec3 position = glm::dvec3(0.0, 0.0, 3.0);
     glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f);
     glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
     glm::vec3 up;
@@ -31,6 +33,8 @@ public:
     float pitch = 0.0f;
     float sensitivity = 0.06f;
     float fov = 45.0f;
+    // no far plane, reversed-z keeps depth precision all the way out
+    float nearPlane = 0.001f;
 
     static Camera &get() {
         static Camera instance;
@@ -40,11 +44,19 @@ public:
     void proessKeyboard(m_Camera direction, float cameraSpeed);
     void processMouseMotion(float xoffset, float yoffset);
 
-    void follow(glm::fmat4 &mat, f_Camera direction, float size);
+    void follow(const glm::dmat4 &mat, f_Camera direction, float size);
     void neutralizeAngles();
     
-    glm::mat4 getViewMatrix() { return glm::lookAt(position, position + front, up); }
-    glm::mat4 getProjectionMatrix() { return glm::perspective(glm::radians(fov), (float)screenWidth / (float)screenHeight, 0.1f, 100.0f); }
+    // floating origin: world positions stay double, whatever goes to the gpu is
+    // made relative to the camera first and only then rounded to float, so
+    // render space has the camera at 0 and the view matrix is rotation only
+    glm::fmat4 toRender(const glm::dmat4 &world) const;
+    glm::fvec3 toRender(const glm::dvec3 &world) const { return glm::fvec3(world - position); }
+
+    glm::mat4 getViewMatrix() { return glm::lookAt(glm::vec3(0.0f), front, up); }
+    // world space, for tests that compare frames while the camera moves
+    glm::dmat4 getWorldViewMatrix() { return glm::lookAt(position, position + glm::dvec3(front), glm::dvec3(up)); }
+    glm::mat4 getProjectionMatrix() { return reversedPerspective(glm::radians(fov), (float)screenWidth / (float)screenHeight, nearPlane); }
 
 private:
     Camera();
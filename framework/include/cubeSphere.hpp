@@ -0,0 +1,17 @@
+#ifndef CUBESPHERE_HPP
+#define CUBESPHERE_HPP
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// direction on the unit sphere of texel (x, y) on cube face 0..5,
+// faces and orientation follow GL_TEXTURE_CUBE_MAP_POSITIVE_X + face
+glm::vec3 cubeFaceDirection(int face, int x, int y, int faceSize);
+
+// reprojects an equirectangular map (row 0 = north pole, +y up) into the six
+// faces of a cube-sphere, returns 6 * faceSize * faceSize * channels bytes
+std::vector<unsigned char> reprojectToCubeSphere(const unsigned char* data, int width, int height,
+                                                 int channels, int faceSize);
+
+#endif
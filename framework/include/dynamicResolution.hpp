@@ -0,0 +1,68 @@
+#ifndef DYNAMICRESOLUTION_HPP
+#define DYNAMICRESOLUTION_HPP
+
+#include "glewInc.hpp"
+
+// gpu time of a stretch of commands; results are picked up a few frames
+// later from a ring of queries, so nothing ever waits on the gpu
+class GpuTimer {
+public:
+    GpuTimer() {}
+
+    // needs a context
+    void initialize();
+    // around the commands to measure, at most once per frame, not nestable
+    void begin();
+    void end();
+    // the newest finished measurement, false if none came in since the last call
+    bool poll(double &ms);
+
+    static const int latency = 4;
+
+private:
+    GLuint queries[latency] = {};
+    bool pending[latency] = {};
+    int next = 0;
+    bool running = false;
+};
+
+// picks the scene's render scale from the gpu frame time, a PID controller
+// on the relative error against the target; the scale only moves in steps
+// so the scene target is not resized by a pixel every frame
+class DynamicResolution {
+public:
+    DynamicResolution() {}
+
+    // feeds one measured frame, returns the new scale
+    float update(double frameMs, float targetMs);
+    // back to native, e.g. when the mode is switched off
+    void reset();
+    float getScale() const { return scale; }
+
+    static constexpr float minScale = 0.5f;
+    static constexpr float maxScale = 1.0f;
+    static constexpr float step = 1.0f / 32.0f;
+
+private:
+    // scale change per unit of relative error
+    float kp = 0.1f;
+    float ki = 0.25f;
+    float kd = 0.05f;
+    float lastError = 0.0f;
+    float olderError = 0.0f;
+    // the unquantized controller output
+    float target = 1.0f;
+    float scale = 1.0f;
+};
+
+struct ResolutionStats {
+    float scale = 1.0f;
+    // of the last finished timer query
+    double gpuMs = 0.0;
+    int width = 0;
+    int height = 0;
+};
+
+extern ResolutionStats resolutionStats;
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include "simd.hpp"
+
+#include <glm/glm.hpp>
+
+// six clip planes pulled out of a view-projection matrix, normals point inwards
+class Frustum {
+public:
+    Frustum() {}
+
+    void extract(const glm::mat4 &viewProjection);
+
+    bool testSphere(const glm::vec3 &center, float radius) const;
+    // bit i of the result is set if sphere i intersects the frustum
+    int testSpheres4(float4 x, float4 y, float4 z, float4 radius) const;
+
+    const glm::vec4* getPlanes() const { return planes; }
+
+private:
+    glm::vec4 planes[6];
+};
+
+struct CullingStats {
+    unsigned int nodesVisible = 0;
+    unsigned int nodesCulled = 0;
+    // inside the frustum but behind the hi-z readback
+    unsigned int nodesOccluded = 0;
+    unsigned int asteroidsVisible = 0;
+    unsigned int asteroidsCulled = 0;
+    // counts above stay on the gpu for any other path
+    const char* asteroidPath = "cpu";
+    // the gpu path also ran the two hi-z passes
+    bool asteroidOcclusion = false;
+};
+
+extern CullingStats cullingStats;
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef GEOMETRYARENA_HPP
+#define GEOMETRYARENA_HPP
+
+#include "glewInc.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// the one vertex layout every mesh shares: location 0 position, 1 texcoord, 2 normal
+struct Vertex {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec2 texCoord = glm::vec2(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);
+};
+
+// where a mesh lives, indices are relative to baseVertex so moving the
+// vertices never rewrites the index data
+struct MeshRange {
+    GLint baseVertex = 0;
+    GLuint vertexCount = 0;
+    GLuint firstIndex = 0;
+    GLsizei indexCount = 0;
+    bool live = false;
+};
+
+// first fit over [0, capacity), neighbouring free blocks are merged on release
+class FreeList {
+public:
+    FreeList() {}
+
+    void reset(GLuint aCapacity);
+    // offset of count free elements, -1 if no block is big enough
+    long long allocate(GLuint count);
+    void release(GLuint offset, GLuint count);
+    // appends [capacity, newCapacity) as free space
+    void grow(GLuint newCapacity);
+
+    GLuint getCapacity() const { return capacity; }
+    GLuint getUsed() const { return used; }
+    unsigned int getHoles() const { return (unsigned int)blocks.size(); }
+    // free elements in front of the last live one, what compaction would win back
+    GLuint getFragmented() const;
+
+private:
+    struct Block {
+        GLuint offset;
+        GLuint count;
+    };
+    std::vector<Block> blocks;
+    GLuint capacity = 0;
+    GLuint used = 0;
+};
+
+// sub-allocates every mesh from one vertex and one index buffer, so all of
+// them draw from the same vao with base vertex / first index offsets
+class GeometryArena {
+public:
+    static GeometryArena &get() {
+        static GeometryArena instance;
+        return instance;
+    }
+
+    // uploads a mesh and returns its handle, grows the buffers when full
+    int allocate(const std::vector<Vertex> &vertices, const std::vector<GLuint> &indices);
+    // compacts once either buffer has more than maxHoles holes or more than
+    // maxFragmented of it lies free between live meshes
+    void release(int handle);
+    // packs the live meshes to the front of fresh buffers, handles stay valid
+    void compact();
+
+    static const unsigned int maxHoles = 16;
+    static constexpr float maxFragmented = 0.25f;
+
+    const MeshRange &getRange(int handle) const { return ranges[handle]; }
+    // every mesh drawn without extra attributes uses this one
+    GLuint getVertexArray();
+    // another vao over the arena buffers, for meshes that add per-instance attributes
+    GLuint createVertexArray();
+
+    void draw(int handle, GLenum mode, GLsizei instances = 1) const;
+
+    const FreeList &getVertexSpace() const { return vertexSpace; }
+    const FreeList &getIndexSpace() const { return indexSpace; }
+
+private:
+    GeometryArena() {}
+    void reserve(GLuint vertices, GLuint indices);
+    void describe(GLuint vao);
+    bool fragmented(const FreeList &space) const;
+
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    FreeList vertexSpace;
+    FreeList indexSpace;
+    std::vector<MeshRange> ranges;
+    // the shared vao first, re-pointed whenever the buffers are replaced
+    std::vector<GLuint> vertexArrays;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef GLSTATE_HPP
+#define GLSTATE_HPP
+
+#include "glewInc.hpp"
+
+struct GLStateStats {
+    unsigned int issued = 0;   // reached the driver
+    unsigned int filtered = 0; // dropped because the state was already set
+};
+
+extern GLStateStats glStateStats;
+extern GLStateStats lastGLStateStats;
+
+// shadows the bits of GL state the frame touches and drops calls that
+// would not change anything, everything drawn per frame goes through here
+class GLState {
+public:
+    static GLState &get() {
+        static GLState instance;
+        return instance;
+    }
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    // selects the unit first if needed, 2d and cube map bindings are tracked apart
+    void bindTexture(unsigned int unit, GLenum target, GLuint texture);
+    // for glTexParameter calls on a texture bound earlier
+    void activeTexture(unsigned int unit);
+    void bindFramebuffer(GLuint framebuffer);
+    void depthFunc(GLenum func);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    // uniform buffer ranges, tracked for the first maxBindings binding points
+    void bindBufferRange(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+    // forget the shadow copy after code that talks to GL directly (setup, ImGui)
+    void invalidate();
+
+    static const unsigned int maxUnits = 16;
+    static const unsigned int maxBindings = 4;
+
+private:
+    GLState() { invalidate(); }
+    bool changed(bool differs);
+
+    GLuint program;
+    GLuint vao;
+    GLuint framebuffer;
+    GLenum depth;
+    unsigned int activeUnit;
+    GLuint textures2D[maxUnits];
+    GLuint texturesCube[maxUnits];
+    GLint view[4];
+    GLuint rangeBuffers[maxBindings];
+    GLintptr rangeOffsets[maxBindings];
+};
+
+#endif
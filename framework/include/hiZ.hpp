@@ -0,0 +1,78 @@
+#ifndef HIZ_HPP
+#define HIZ_HPP
+
+#include "glewInc.hpp"
+#include "shader.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// hierarchical-z pyramid of a reversed-z depth buffer at half resolution, every
+// texel keeps the farthest depth below it; a bounding sphere whose closest point is
+// behind that depth over its whole screen rect is hidden. include/hiZ.glsl has
+// the same test for shaders, occluded() runs it on the cpu against one coarse
+// level that is read back a frame or two late
+class HiZ {
+public:
+    HiZ() {}
+
+    // needs a context, width and height are the depth buffer's
+    void initialize(int aWidth, int aHeight);
+    // reduces depth, drawn with view and projection, into the pyramid and
+    // queues the readback; leaves the pyramid's framebuffer and viewport bound.
+    // view is the world space one, in double so the camera can be anywhere.
+    // extent is the corner of depth the scene was drawn to, the rest must hold
+    // the cleared value so it never hides anything
+    void build(GLuint depth, const glm::dmat4 &aView, const glm::mat4 &aProjection, const glm::ivec2 &aExtent);
+    // picks up a finished readback, never waits on the gpu
+    void poll();
+    // against the last readback, with the matrices it was drawn with;
+    // false until the first one arrives
+    bool occluded(const glm::dvec3 &center, float radius) const;
+
+    bool isBuilt() const { return built; }
+    GLuint getTexture() const { return texture; }
+    int getLevels() const { return levels; }
+    // the part of the depth buffer the last build covered, level 0 is half of it
+    glm::ivec2 getSize() const { return extent; }
+    // rounded to float, for world positions near the origin (the belt)
+    glm::mat4 getView() const { return glm::mat4(view); }
+    const glm::mat4 &getProjection() const { return projection; }
+
+private:
+    struct Readback {
+        GLuint buffer = 0;
+        GLsync fence = 0;
+        glm::dmat4 view = glm::dmat4(1.0);
+        glm::mat4 projection = glm::mat4(1.0f);
+        glm::ivec2 extent = glm::ivec2(0);
+    };
+
+    int width = 0;
+    int height = 0;
+    int levels = 0;
+    GLuint texture = 0;
+    std::vector<GLuint> framebuffers;
+    glm::dmat4 view = glm::dmat4(1.0);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::ivec2 extent = glm::ivec2(0);
+    bool built = false;
+
+    Shader shader;
+    Uniform<int> sourceUniform;
+
+    // two pbos in flight, the cpu copy holds the newest finished one
+    Readback readbacks[2];
+    int nextReadback = 0;
+    int readLevel = 0;
+    int readWidth = 0;
+    int readHeight = 0;
+    std::vector<float> readDepth;
+    glm::dmat4 readView = glm::dmat4(1.0);
+    glm::mat4 readProjection = glm::mat4(1.0f);
+    glm::ivec2 readExtent = glm::ivec2(0);
+    bool readValid = false;
+};
+
+#endif
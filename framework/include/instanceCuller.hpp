@@ -0,0 +1,88 @@
+#ifndef INSTANCECULLER_HPP
+#define INSTANCECULLER_HPP
+
+#include "glewInc.hpp"
+#include "frustum.hpp"
+#include "shader.hpp"
+#include "geometryArena.hpp"
+#include "hiZ.hpp"
+
+// where instances are tested against the frustum
+enum CullPath {
+    CULL_CPU,      // no gpu path, the caller culls while it writes instances
+    CULL_COMPUTE,  // compute shader, GL 4.3 or ARB_compute_shader
+    CULL_FEEDBACK  // geometry shader + transform feedback, needs ARB_query_buffer_object
+};
+
+// same layout as the one GL reads from GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// gpu frustum culling of vec4 instances (xyz position, w scale); the visible
+// ones are compacted into getOutput() and counted into an indirect draw
+// command, so nothing is read back to the cpu. the compute path also tests
+// against a hi-z pyramid in two passes: the first against last frame's depth,
+// the second re-tests what that one hid against this frame's, so nothing
+// that came into view stays missing for a frame
+class InstanceCuller {
+public:
+    InstanceCuller() {}
+
+    // best path the context supports, CULL_CPU if neither gpu path is there
+    static CullPath detect();
+
+    // builds the programs and buffers for path, needs a context
+    void initialize(CullPath aPath);
+    // room for capacity instances
+    void resize(int capacity);
+    // culls count instances, offset bytes into the instances buffer, into a
+    // command drawing mesh, meshRadius is the bounding radius of the mesh at
+    // scale 1; with a built hiZ (compute path only) occluded instances are held
+    // for retest(). offset is a multiple of 256 for the storage buffer binding
+    void cull(GLuint instances, GLintptr offset, int count, const Frustum &frustum, float meshRadius,
+              const MeshRange &mesh, const HiZ* hiZ = nullptr);
+    // second pass over what cull() found occluded, hiZ rebuilt since then;
+    // the survivors are drawn by the command at getRetestOffset()
+    void retest(const HiZ &hiZ, float meshRadius);
+    // cull() held instances back, the second command has to be drawn
+    bool hasRetest() { return retesting; }
+    CullPath getPath() { return path; }
+    GLuint getOutput() { return output; }
+    GLuint getCommands() { return commands; }
+    GLintptr getRetestOffset() { return sizeof(DrawElementsIndirectCommand); }
+    const char* getPathName();
+
+private:
+    void setHiZ(const HiZ &hiZ);
+
+    CullPath path = CULL_CPU;
+    int capacity = 0;
+
+    GLuint output = 0;
+    // two commands and the occluded count
+    GLuint commands = 0;
+    // compute path only, instances waiting for the retest
+    GLuint occluded = 0;
+    int dispatched = 0;
+    bool retesting = false;
+    // feedback path only, reads the instance buffer as points
+    GLuint sourceVAO = 0;
+    GLuint query = 0;
+
+    Shader shader;
+    Uniform<glm::fvec4> planesUniform;
+    Uniform<int> countUniform;
+    Uniform<float> radiusUniform;
+    Uniform<int> hiZUniform;
+    Uniform<glm::fmat4> hiZViewUniform;
+    Uniform<glm::fmat4> hiZProjectionUniform;
+    Uniform<glm::ivec2> hiZSizeUniform;
+    Uniform<int> hiZLevelsUniform;
+};
+
+#endif
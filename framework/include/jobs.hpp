@@ -0,0 +1,45 @@
+#ifndef JOBS_HPP
+#define JOBS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// persistent worker pool, one thread per extra core
+class Jobs {
+public:
+    static Jobs &get() {
+        static Jobs instance;
+        return instance;
+    }
+
+    // runs job(begin, end) over chunks of [0, count) on all cores including the
+    // calling one and returns when every chunk is done, not reentrant
+    void parallelFor(int count, const std::function<void(int, int)> &job);
+
+    unsigned int getThreadCount() { return (unsigned int)workers.size() + 1; }
+
+private:
+    Jobs();
+    ~Jobs();
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(int, int)>* current = nullptr;
+    std::atomic<int> next;
+    int total = 0;
+    int chunk = 1;
+    unsigned int busy = 0;
+    unsigned int generation = 0;
+    bool quit = false;
+};
+
+#endif
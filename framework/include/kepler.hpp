@@ -0,0 +1,34 @@
+#ifndef KEPLER_HPP
+#define KEPLER_HPP
+
+#include <glm/glm.hpp>
+
+// classical elements, angles in radians. the ecliptic's x / y lie in the
+// scene's xz plane (x along +z, y along +x) and its north is +y, so with every
+// angle at 0 the body starts on +z and turns towards +x like the planets always did
+struct OrbitalElements {
+    double semiMajorAxis = 1.0;
+    double eccentricity = 0.0;
+    double inclination = 0.0;
+    double ascendingNode = 0.0;
+    double periapsis = 0.0;
+};
+
+// an ellipse placed in render space, p and q as from orbitAxes
+struct OrbitPath {
+    glm::fvec3 focus;
+    glm::fvec3 p;
+    glm::fvec3 q;
+    float eccentricity;
+};
+
+// scene axes of the orbit, towards periapsis scaled by the semi-major axis and
+// 90 degrees ahead of it scaled by the semi-minor axis; the focus is the origin
+// and position = (cos E - e) * p + sin E * q for eccentric anomaly E
+void orbitAxes(const OrbitalElements &elements, glm::dvec3 &p, glm::dvec3 &q);
+// E - e sin E = M by newton's method, fine for any closed orbit
+double eccentricAnomaly(double meanAnomaly, double eccentricity);
+// position relative to the focus at meanAnomaly
+glm::dvec3 orbitPosition(const OrbitalElements &elements, double meanAnomaly);
+
+#endif
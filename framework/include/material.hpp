@@ -0,0 +1,45 @@
+#ifndef MATERIAL_HPP
+#define MATERIAL_HPP
+
+#include "glewInc.hpp"
+#include "uniformBuffer.hpp"
+
+// mirrors the std140 Material block in shaders/include/material.glsl
+struct MaterialData {
+    float shininess = 32.0f;
+    float ambient = 0.1f;
+    float reflectivity = 0.5f;
+    float padding = 0.0f;
+};
+
+const GLuint materialBinding = 1;
+
+// surface parameters of one kind of body; every material owns an aligned
+// range of one shared uniform buffer, so switching is a single range bind
+class Material {
+public:
+    Material() {}
+
+    // allocates the shared buffer for up to capacity materials, needs a context
+    static void initialize(unsigned int capacity);
+
+    void create();
+    // uploads only if the parameters changed since the last call
+    bool update(const MaterialData& aData);
+    void bind() const;
+
+    const MaterialData &getData() const { return data; }
+    // 1-based slot in the shared buffer, 0 before create(), for sort keys
+    unsigned int getIndex() const { return offset < 0 ? 0 : (unsigned int)(offset / stride) + 1; }
+
+private:
+    static UniformBuffer storage;
+    static GLintptr stride;
+    static unsigned int capacity;
+    static unsigned int count;
+
+    GLintptr offset = -1;
+    MaterialData data;
+};
+
+#endif
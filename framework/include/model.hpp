@@ -2,6 +2,7 @@
 #define MODEL_HPP
 
 #include "glewInc.hpp"
+#include "geometryArena.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -16,16 +17,20 @@ struct vertexInfo {
     float z = 0.0f;
 };
 
+// a mesh in the geometry arena, VAO is the arena's shared one unless the
+// mesh has per-instance attributes of its own
 struct modelObject {
     GLuint VAO = 0;
-    GLuint VBO = 0;
-    GLuint NBO = 0;
-    GLuint TBO = 0;
-    GLuint EBO = 0;
     GLenum draw_mode = GL_NONE;
-    GLsizei num_elements = 0;
+    GLsizei num_elements = 0; // indices
+    int mesh = -1;            // GeometryArena handle
 };
 
+// hands vertices and indices to the geometry arena
+void uploadMesh(modelObject &object, const std::vector<Vertex> &vertices, const std::vector<GLuint> &indices, GLenum draw_mode);
+// draws instances of object from the arena with its base vertex / first index
+void drawMesh(const modelObject &object, GLsizei instances = 1);
+
 class Model {
 public:
     Model() {};
@@ -40,9 +45,18 @@ public:
     void setGeometry(GLenum draw_mode);
     void setVertexAttributes();
     void draw();
+    // per-instance vec4 (position, scale) from buffer at attribute 3, starting offset bytes in
+    void setInstanceBuffer(GLuint buffer, GLintptr offset = 0);
     void instanceDraw(int amount);
+    // count and instance count come from a DrawElementsIndirectCommand written on the gpu,
+    // offset bytes into the commands buffer
+    void indirectDraw(GLuint commands, GLintptr offset = 0);
+    // gives the arena range back, the mesh cannot be drawn afterwards
+    void release();
 
     std::vector<glm::vec3> getVertices() { return out_vertices; }
+    // distance of the farthest vertex from the origin, for bounding spheres
+    float getBoundingRadius() { return boundingRadius; }
 
 private:
     std::vector<glm::vec3> out_vertices;
@@ -63,6 +77,7 @@ private:
     bool gotIndex = false;
 
     unsigned short vertexAttribs;
+    float boundingRadius = 0.0f;
 
     modelObject model_object;
 };
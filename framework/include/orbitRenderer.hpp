@@ -0,0 +1,57 @@
+#ifndef ORBITRENDERER_HPP
+#define ORBITRENDERER_HPP
+
+#include "glewInc.hpp"
+#include "shader.hpp"
+#include "frustum.hpp"
+#include "streamBuffer.hpp"
+#include "kepler.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+struct OrbitStats {
+    unsigned int drawn = 0;
+    unsigned int culled = 0;
+    unsigned int vertices = 0;
+    // 1 with anything visible, every orbit goes out in the same call
+    unsigned int draws = 0;
+};
+
+extern OrbitStats orbitStats;
+
+// orbits are tessellated on the cpu every frame, each one finely enough that no
+// chord strays more than maxError pixels from the true ellipse where it passes
+// closest to the camera, and written as line strips into one stream buffer.
+// a single glMultiDrawArrays draws them all, so a far orbit costs a dozen
+// vertices and a thousand of them cost one draw call
+class OrbitRenderer {
+public:
+    OrbitRenderer() {}
+
+    // needs a context
+    void initialize();
+
+    // starts a frame, the paths pushed after it are drawn by the next draw()
+    void clear() { paths.clear(); }
+    void push(const OrbitPath &path) { paths.push_back(path); }
+    // culls against frustum (render space), then tessellates and draws with
+    // shader, which only needs FrameData; pixelScale is the projection's
+    // [1][1] times half the viewport height, pixels per unit at distance 1
+    void draw(Shader &shader, const Frustum &frustum, float pixelScale, float maxError = 0.5f);
+
+    static const int minSegments = 12;
+    static const int maxSegments = 2048;
+
+private:
+    std::vector<OrbitPath> paths;
+    std::vector<int> segments;
+    std::vector<GLint> firsts;
+    std::vector<GLsizei> counts;
+
+    StreamBuffer vertices;
+    GLuint vao = 0;
+};
+
+#endif
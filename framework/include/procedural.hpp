@@ -0,0 +1,20 @@
+#ifndef PROCEDURAL_HPP
+#define PROCEDURAL_HPP
+
+#include <string>
+#include <vector>
+
+// increase whenever the generator output changes so old cache files get rebuilt
+const unsigned int proceduralVersion = 1;
+
+// stable per body seed, FNV-1a over the name
+unsigned int proceduralSeed(const std::string& name);
+
+// synthesizes a cube-sphere surface (same face layout as reprojectToCubeSphere,
+// 3 channels) from fBm and cellular noise, evaluated 4 texels at a time on all cores
+std::vector<unsigned char> generateSurface(unsigned int seed, int faceSize);
+
+// generateSurface backed by a disk cache in resources/cache/procedural
+std::vector<unsigned char> proceduralSurface(unsigned int seed, int faceSize);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+#include "glewInc.hpp"
+#include "shader.hpp"
+#include "material.hpp"
+#include "texture.hpp"
+#include "model.hpp"
+#include "streamBuffer.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// the Instances block in shaders/include/instance.glsl
+const GLuint instanceBinding = 2;
+const int maxInstances = 64;
+
+// passes are the most significant bits of the key, they draw in this order
+enum RenderPass {
+    PASS_OPAQUE, PASS_LINES
+};
+
+// everything a draw needs, the textures go to units 0..2
+struct DrawPacket {
+    unsigned long long key = 0;
+    Shader* shader = nullptr;
+    const Material* material = nullptr;
+    Texture* textures[3] = { nullptr, nullptr, nullptr };
+    const modelObject* mesh = nullptr;
+    glm::fmat4 model = glm::fmat4(1.0f);
+};
+
+struct RenderQueueStats {
+    unsigned int packets = 0; // pushed during traversal
+    unsigned int draws = 0;   // instanced draws after merging
+};
+
+extern RenderQueueStats renderQueueStats;
+
+// traversal pushes packets instead of drawing; they are sorted by a 64-bit key
+//   63..60 pass | 59..48 program | 47..40 material | 39..24 texture | 23..16 mesh | 15..0 depth
+// and runs of packets with the same state become one instanced draw, so the
+// frame pays per distinct state rather than per body. storage is reused, a
+// frame allocates nothing once the vectors have grown
+class RenderQueue {
+public:
+    RenderQueue() {}
+
+    // instance buffer and offset alignment, needs a context
+    void initialize(float aNearPlane);
+
+    // starts a frame, depth in the key is log2 of the distance to viewPos over
+    // the near plane, depthOctaves of them spread over the 16 bits
+    void clear(const glm::fvec3 &viewPos);
+    void push(RenderPass pass, Shader &shader, const Material* material, const modelObject &mesh,
+              const glm::fmat4 &model, Texture* const* textures = nullptr, int textureCount = 0);
+    // radix sort on the keys, then uploads all matrices at once and draws
+    void submit();
+
+    // with the near plane at 0.001 this reaches past 1e10
+    static constexpr float depthOctaves = 48.0f;
+
+private:
+    struct Batch {
+        unsigned int first;
+        unsigned int count;
+        GLintptr offset;
+    };
+
+    void sort();
+    static bool compatible(const DrawPacket &a, const DrawPacket &b);
+
+    std::vector<DrawPacket> packets;
+    std::vector<unsigned int> order;
+    std::vector<unsigned int> scratch;
+    std::vector<Batch> batches;
+    std::vector<glm::fmat4> matrices;
+
+    StreamBuffer matrixStream;
+    // batch offsets are rounded up to this many matrices
+    unsigned int matrixAlignment = 1;
+    float nearPlane = 0.001f;
+    glm::fvec3 viewPosition = glm::fvec3(0.0f);
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef REVERSEDZ_HPP
+#define REVERSEDZ_HPP
+
+#include "glewInc.hpp"
+
+#include <glm/glm.hpp>
+
+// depth runs backwards, 1 at the near plane and 0 at infinity, so a float
+// depth buffer keeps its precision out to astronomical distances; nearer
+// fragments pass with GL_GREATER and depth is cleared to 0
+enum DepthMode {
+    DEPTH_CLIP_CONTROL, // glClipControl zero to one, the projection writes near / distance
+    DEPTH_LOGARITHMIC   // no clip control, fragment shaders write it with LOG_DEPTH
+};
+
+// far end of the logarithmic mapping, the same as include/depth.glsl
+const float logDepthFar = 1e10f;
+
+// picks the mode and sets clip control, clear depth and depth func; needs a
+// context and has to run before any shader is built
+DepthMode initializeDepth();
+DepthMode getDepthMode();
+const char* getDepthModeName();
+
+// infinite far plane, clip z is the near distance so z / w = near / distance
+glm::mat4 reversedPerspective(float fovy, float aspect, float nearPlane);
+
+// the depth buffer value at a view distance, what the shaders write in either mode
+float reversedDepth(float distance, float nearPlane);
+
+#endif
@@ -10,20 +10,100 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <initializer_list>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+// uniform resolved once after linking, typed so the matching Shader::set
+// overload is picked at compile time; the slot maps to a location per variant
+template <typename T>
+struct Uniform {
+    int slot = -1;
+};
+
+// one linked permutation of a shader
+struct ShaderProgram {
+    unsigned int ID = 0;
+    std::unordered_map<std::string, GLint> uniforms;
+    std::vector<GLint> slots;
+    GLint modelLocation = -1;
+
+    // submitted to the driver but link status not read yet
+    bool pending = false;
+    bool fromBinary = false;
+    unsigned int mask = 0;
+    // compiled stages, detached and deleted once linked
+    std::vector<unsigned int> stages;
+    std::string cachePath;
+};
+
+// per frame driver call counters, shown in the debug viewer
+struct ShaderStats {
+    unsigned int nameLookups = 0;     // by name set* calls, each one was a glGetUniformLocation before
+    unsigned int locationQueries = 0; // glGetUniformLocation calls actually issued
+    unsigned int uploads = 0;         // glUniform* calls
+};
+
+extern ShaderStats shaderStats;
+extern ShaderStats lastShaderStats;
+
+// how the programs were created at startup, all loaded = warm start
+struct ShaderCacheStats {
+    unsigned int loaded = 0;   // restored with glProgramBinary
+    unsigned int compiled = 0; // compiled and linked from source
+    double startupMs = 0.0;    // submitting every program in setup until the last one linked
+    double waitMs = 0.0;       // blocked on link status, at the end of setup or at first use
+};
+
+extern ShaderCacheStats shaderCacheStats;
 
 class Shader {
 
 public:
     Shader();
-    Shader(std::string str);
+    // features are #define names, a variant enables a subset of them; str.comp
+    // makes a compute program, str.geom adds a geometry stage and str.frag may
+    // be left out when rasterization is discarded
+    Shader(std::string str, std::vector<std::string> aFeatures = {});
     
     void setSource(std::string str);
     unsigned int compileShader(unsigned int type, const std::string& source);
+    // only submits the program, the link status is read on the first use()
     void createShader();
-    unsigned int &getID();
+    unsigned int getID() const;
+
+    // true once the driver has finished, never blocks
+    bool isReady() const;
+    // waits for the driver and builds the uniform tables, use() does this on demand
+    void complete();
+
+    // bit i enables features[i]; variants are compiled on first use and kept
+    void setVariant(unsigned int mask);
+    void setVariant(std::initializer_list<bool> flags);
+
+    GLint getLocation(const std::string &name) const;
+    template <typename T>
+    Uniform<T> getUniform(const std::string &name) { return Uniform<T>{ getSlot(name) }; }
+
+    // outputs captured by transform feedback, interleaved, before createShader
+    void setFeedbackVaryings(std::vector<std::string> varyings) { feedbackVaryings = varyings; }
+
+    // programs linked afterwards get the named uniform block bound to this point
+    static void registerBlock(const std::string &name, GLuint binding);
+    // programs built afterwards get #define name, for settings of the whole renderer
+    static void define(const std::string &name);
 
     void use();
+    void set(Uniform<bool> uniform, bool value) const;
+    void set(Uniform<int> uniform, int value) const;
+    void set(Uniform<float> uniform, float value) const;
+    void set(Uniform<glm::ivec2> uniform, const glm::ivec2 &value) const;
+    void set(Uniform<glm::fvec2> uniform, const glm::fvec2 &value) const;
+    void set(Uniform<glm::fvec3> uniform, const glm::fvec3 &value) const;
+    void set(Uniform<glm::fvec4> uniform, const glm::fvec4 *values, int count) const;
+    void set(Uniform<glm::fmat4> uniform, const glm::fmat4 &mat) const;
+
     void setBool(const std::string &name, bool value) const;
     void setInt(const std::string &name, int value) const;
     void setFloat(const std::string &name, float value) const;
@@ -36,16 +116,42 @@ public:
     void setfMat2(const std::string &name, const glm::fmat2 &mat) const;
     void setfMat3(const std::string &name, const glm::fmat3 &mat) const;
     void setfMat4(const std::string &name, const glm::fmat4 &mat) const;
-    void setView(const glm::fmat4 &mat) const;
-    void setProjection(const glm::fmat4 &mat) const;
-    void setModel(const glm::fmat4 &mat = glm::fmat4(1.0f)) const;
+    // binds the program like use(), camera matrices come from FrameData
+    void setModel(const glm::fmat4 &mat = glm::fmat4(1.0f));
 
 private:
-    unsigned int ID;
+    std::string variantDefines(unsigned int mask) const;
+    // allowBinary false always compiles, for when the cached binary was rejected
+    void submitVariant(ShaderProgram& program, unsigned int mask, bool allowBinary = true);
+    void completeVariant(ShaderProgram& program);
+    std::string binaryCachePath(const std::vector<std::string>& sources);
+    bool loadBinary(ShaderProgram& program, const std::string& path);
+    void saveBinary(ShaderProgram& program, const std::string& path);
+    void reflectUniforms(ShaderProgram& program);
+    void bindUniformBlocks(ShaderProgram& program);
+    static GLint findLocation(const ShaderProgram& program, const std::string &name);
+    int getSlot(const std::string &name);
+    GLint slotLocation(int slot) const;
+    GLint nameLocation(const std::string &name) const;
+
+    std::unordered_map<unsigned int, ShaderProgram> variants;
+    ShaderProgram* current = nullptr;
+    unsigned int variant = 0;
+    bool loaded = false;
+
+    std::vector<std::string> features;
+    std::vector<std::string> slotNames;
+    std::vector<std::string> feedbackVaryings;
     std::string vertexSource;
 	std::string fragmentSource;
+    std::string geometrySource;
+    std::string computeSource;
+    std::string vertexCode;
+    std::string fragmentCode;
+    std::string geometryCode;
+    std::string computeCode;
 };
 
-std::string ParseShader(const std::string& filepath);
+std::string ParseShader(const std::string& filepath, int depth = 0);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+// minimal 4-wide float vector, SSE2 where available (every x64 target),
+// plain arrays otherwise so the same kernels build everywhere
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#else
+#include <cmath>
+#endif
+
+struct float4 {
+#ifdef SIMD_SSE2
+    __m128 v;
+#else
+    float v[4];
+#endif
+};
+
+#ifdef SIMD_SSE2
+
+inline float4 splat(float a) { return { _mm_set1_ps(a) }; }
+inline float4 load4(const float* p) { return { _mm_loadu_ps(p) }; }
+inline void store4(float* p, float4 a) { _mm_storeu_ps(p, a.v); }
+
+inline float4 operator+(float4 a, float4 b) { return { _mm_add_ps(a.v, b.v) }; }
+inline float4 operator-(float4 a, float4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline float4 operator*(float4 a, float4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline float4 operator/(float4 a, float4 b) { return { _mm_div_ps(a.v, b.v) }; }
+
+inline float4 min4(float4 a, float4 b) { return { _mm_min_ps(a.v, b.v) }; }
+inline float4 max4(float4 a, float4 b) { return { _mm_max_ps(a.v, b.v) }; }
+inline float4 sqrt4(float4 a) { return { _mm_sqrt_ps(a.v) }; }
+
+inline float4 floor4(float4 a) {
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return { _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f))) };
+}
+
+// comparisons return all-ones lanes, use with select4 / or4 / mask4
+inline float4 less4(float4 a, float4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline float4 greater4(float4 a, float4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+inline float4 select4(float4 mask, float4 a, float4 b) {
+    return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+}
+inline int mask4(float4 mask) { return _mm_movemask_ps(mask.v); }
+inline float4 or4(float4 a, float4 b) { return { _mm_or_ps(a.v, b.v) }; }
+
+// rows become columns, turns 4 SoA lanes into 4 interleaved vec4s
+inline void transpose4(float4 &a, float4 &b, float4 &c, float4 &d) { _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v); }
+
+#else
+
+inline float4 splat(float a) { return { { a, a, a, a } }; }
+inline float4 load4(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+inline void store4(float* p, float4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+
+#define SIMD_LANEWISE(expr) float4 r; for (int i = 0; i < 4; i++) r.v[i] = (expr); return r;
+
+inline float4 operator+(float4 a, float4 b) { SIMD_LANEWISE(a.v[i] + b.v[i]) }
+inline float4 operator-(float4 a, float4 b) { SIMD_LANEWISE(a.v[i] - b.v[i]) }
+inline float4 operator*(float4 a, float4 b) { SIMD_LANEWISE(a.v[i] * b.v[i]) }
+inline float4 operator/(float4 a, float4 b) { SIMD_LANEWISE(a.v[i] / b.v[i]) }
+
+inline float4 min4(float4 a, float4 b) { SIMD_LANEWISE(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+inline float4 max4(float4 a, float4 b) { SIMD_LANEWISE(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+inline float4 sqrt4(float4 a) { SIMD_LANEWISE(std::sqrt(a.v[i])) }
+inline float4 floor4(float4 a) { SIMD_LANEWISE(std::floor(a.v[i])) }
+
+// masks are stored as 1.0 / 0.0 lanes in the scalar build
+inline float4 less4(float4 a, float4 b) { SIMD_LANEWISE(a.v[i] < b.v[i] ? 1.0f : 0.0f) }
+inline float4 greater4(float4 a, float4 b) { SIMD_LANEWISE(a.v[i] > b.v[i] ? 1.0f : 0.0f) }
+inline float4 select4(float4 mask, float4 a, float4 b) { SIMD_LANEWISE(mask.v[i] != 0.0f ? a.v[i] : b.v[i]) }
+inline int mask4(float4 mask) {
+    int m = 0;
+    for (int i = 0; i < 4; i++) m |= (mask.v[i] != 0.0f) << i;
+    return m;
+}
+inline float4 or4(float4 a, float4 b) { SIMD_LANEWISE(a.v[i] != 0.0f || b.v[i] != 0.0f ? 1.0f : 0.0f) }
+
+inline void transpose4(float4 &a, float4 &b, float4 &c, float4 &d) {
+    float4 r[4] = { a, b, c, d };
+    for (int i = 0; i < 4; i++) {
+        a.v[i] = r[i].v[0];
+        b.v[i] = r[i].v[1];
+        c.v[i] = r[i].v[2];
+        d.v[i] = r[i].v[3];
+    }
+}
+
+#undef SIMD_LANEWISE
+
+#endif
+
+inline float4 fract4(float4 a) { return a - floor4(a); }
+inline float4 mix4(float4 a, float4 b, float4 t) { return a + (b - a) * t; }
+inline float4 clamp4(float4 a, float lo, float hi) { return min4(max4(a, splat(lo)), splat(hi)); }
+
+// sine and cosine from one range reduction to [-pi/2, pi/2] and degree 11 / 10
+// polynomials, ~1e-6 absolute error near zero, large arguments lose precision
+inline void sincos4(float4 x, float4 &s, float4 &c) {
+    const float pi = 3.14159265358979f;
+    // wrap into [-pi, pi]
+    x = x - splat(2.0f * pi) * floor4(x * splat(0.5f / pi) + splat(0.5f));
+    // fold the outer quarters back, sin(pi - x) = sin(x) and cos(pi - x) = -cos(x)
+    float4 high = greater4(x, splat(0.5f * pi));
+    float4 low = less4(x, splat(-0.5f * pi));
+    x = select4(high, splat(pi) - x, x);
+    x = select4(low, splat(-pi) - x, x);
+    float4 x2 = x * x;
+
+    float4 ps = splat(-2.5052108e-8f);
+    ps = ps * x2 + splat(2.7557319e-6f);
+    ps = ps * x2 + splat(-1.9841270e-4f);
+    ps = ps * x2 + splat(8.3333333e-3f);
+    ps = ps * x2 + splat(-1.6666667e-1f);
+    s = x + x * x2 * ps;
+
+    float4 pc = splat(-2.7557319e-7f);
+    pc = pc * x2 + splat(2.4801587e-5f);
+    pc = pc * x2 + splat(-1.3888889e-3f);
+    pc = pc * x2 + splat(4.1666667e-2f);
+    pc = pc * x2 + splat(-0.5f);
+    pc = splat(1.0f) + x2 * pc;
+    c = select4(select4(high, high, low), splat(0.0f) - pc, pc);
+}
+
+inline float4 sin4(float4 x) { float4 s, c; sincos4(x, s, c); return s; }
+inline float4 cos4(float4 x) { float4 s, c; sincos4(x, s, c); return c; }
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef STARCATALOGUE_HPP
+#define STARCATALOGUE_HPP
+
+#include "glewInc.hpp"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// increase whenever PackedStar or the import changes so old cache files get rebuilt
+const unsigned int starCatalogueVersion = 1;
+
+// quantization ranges, stars.vert decodes with the same constants
+const float starMagnitudeMin = -2.0f;
+const float starMagnitudeMax = 14.0f;
+const float starColourMin = -0.5f;
+const float starColourMax = 2.5f;
+
+// 8 bytes a star: octahedral direction as two snorm16, apparent magnitude and
+// B-V colour index as unorm16 over the ranges above
+struct PackedStar {
+    GLshort direction[2];
+    GLushort magnitude;
+    GLushort colour;
+};
+static_assert(sizeof(PackedStar) == 8, "PackedStar is read straight from disk");
+
+struct StarStats {
+    unsigned int loaded = 0;
+    unsigned int drawn = 0;
+    // "catalogue", "cache" or "synthetic"
+    const char* source = "none";
+};
+
+extern StarStats starStats;
+
+// the sky as points at infinity, sorted brightest first so a limiting magnitude
+// is a prefix of the buffer and one draw. resources/stars/<name> is imported
+// once (HYG or Hipparcos csv, columns found by their header) into a binary file
+// under resources/cache/stars; without it a synthetic sky stands in. the import
+// streams the csv and never holds more than 2 * maxStars packed stars, the gpu
+// keeps 8 bytes a star and the cpu only the magnitude prefix table
+class StarCatalogue {
+public:
+    StarCatalogue() {}
+
+    // needs a context; fallbackCount is the size of the synthetic sky
+    void load(const std::string &name, unsigned int fallbackCount = 100000);
+    // stars at or brighter than limit, in one GL_POINTS draw with attribute 0
+    // the direction and attribute 1 magnitude and colour
+    void draw(float limit);
+    GLsizei countBrighterThan(float limit) const;
+
+    unsigned int getCount() const { return count; }
+
+    // scene space, the equator tilted by the obliquity against the ecliptic
+    // (see kepler.hpp for the ecliptic's axes); ra and dec in radians
+    static glm::vec3 equatorialToScene(double ra, double dec);
+    static PackedStar pack(const glm::vec3 &direction, float magnitude, float colour);
+
+    static const unsigned int maxStars = 1 << 18;
+    // prefix table resolution in magnitudes
+    static constexpr float magnitudeStep = 0.1f;
+
+private:
+    static bool importCsv(const std::string &path, std::vector<PackedStar> &stars);
+    static bool readCache(const std::string &path, unsigned long long sourceSize, std::vector<PackedStar> &stars);
+    static void writeCache(const std::string &path, unsigned long long sourceSize, const std::vector<PackedStar> &stars);
+    static void synthesize(unsigned int amount, std::vector<PackedStar> &stars);
+    void upload(std::vector<PackedStar> &stars);
+
+    GLuint vao = 0;
+    GLuint buffer = 0;
+    unsigned int count = 0;
+    // brighter[k] stars are brighter than starMagnitudeMin + k * magnitudeStep
+    std::vector<GLsizei> brighter;
+};
+
+#endif
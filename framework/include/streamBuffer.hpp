@@ -0,0 +1,88 @@
+#ifndef STREAMBUFFER_HPP
+#define STREAMBUFFER_HPP
+
+#include "glewInc.hpp"
+
+#include <vector>
+
+struct StreamStats {
+    double stallMs = 0.0;          // blocked on a fence, the gpu was still reading the region
+    unsigned int stalls = 0;       // frames that had to wait at all
+    unsigned long long bytes = 0;  // written through stream buffers
+};
+
+extern StreamStats streamStats;
+extern StreamStats lastStreamStats;
+
+// how far the cpu may run ahead of the gpu. stream buffers write frame n into
+// region n % framesInFlight, one fence per frame tells when the gpu is done
+// reading every region of it
+class FrameFences {
+public:
+    static FrameFences &get() {
+        static FrameFences instance;
+        return instance;
+    }
+
+    // before the first map of a frame, waits only while the gpu still reads
+    // what was written framesInFlight frames ago
+    void beginFrame();
+    // after the last command reading this frame's data
+    void endFrame();
+
+    unsigned long long getFrame() const { return frame; }
+    int getRegion() const { return (int)(frame % framesInFlight); }
+
+    static const int framesInFlight = 3;
+
+private:
+    FrameFences() {}
+
+    GLsync fences[framesInFlight] = {};
+    unsigned long long frame = 0;
+};
+
+// ring allocator for data rewritten every frame (instance matrices, uniform
+// blocks, the belt). with glBufferStorage the buffer stays mapped for good and
+// the fences above are the only synchronisation; without it (gl 3.x) it is
+// orphaned once a frame and written through unsynchronized maps. either way a
+// write never waits for the gpu inside the driver
+class StreamBuffer {
+public:
+    StreamBuffer() {}
+
+    // needs a context; frameSize is what one frame is expected to write, it
+    // grows on demand. a second call starts over with fresh storage
+    void create(GLenum aTarget, GLsizeiptr frameSize);
+    // room for size bytes in this frame's region at a suitably aligned offset
+    // into getID(); write it, unmap(), then draw from it. growing retires the
+    // storage, pointers from earlier maps this frame must be unmapped by then
+    void* map(GLsizeiptr size, GLintptr &offset);
+    void unmap();
+
+    GLuint getID() const { return buffer; }
+    // glBufferStorage, gl 4.4 or ARB_buffer_storage
+    static bool isPersistent();
+
+private:
+    struct Retired {
+        GLuint buffer;
+        unsigned long long frame;
+    };
+
+    void allocate(GLsizeiptr aRegionSize);
+    void retire();
+
+    GLenum target = GL_ARRAY_BUFFER;
+    GLuint buffer = 0;
+    GLsizeiptr regionSize = 0;
+    GLintptr alignment = 1;
+    GLintptr head = 0;
+    unsigned long long frame = ~0ull;
+    // the whole buffer, persistent path only
+    unsigned char* mapped = nullptr;
+    // storage replaced by a larger one, deleted once the gpu is past it
+    std::vector<Retired> retired;
+};
+
+#endif
@@ -15,10 +15,15 @@ public:
 
     void setTexturePath(const std::string& aPath);
     void set2DTexture(const GLenum& wrapper, const GLenum& filter);
-    void bind();
+    void setCubeSphereTexture(const GLenum& filter);
+    void setProceduralTexture(unsigned int seed, int faceSize, const GLenum& filter);
+    void bind(unsigned int unit = 0);
 
 private:
+    void uploadCubeFaces(const unsigned char* faces, int faceSize, const GLenum& filter);
+
     unsigned int texture;
+    GLenum target = GL_TEXTURE_2D;
     std::string path;    
 };
 
@@ -0,0 +1,74 @@
+#ifndef TRIPLEBUFFER_HPP
+#define TRIPLEBUFFER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+// hands whole values from one producer thread to one consumer thread without
+// locks. the producer fills back() and publish() trades it for the middle
+// slot, the consumer's acquire() trades its front() for the middle slot when
+// that one is newer. neither side ever blocks, a value the consumer was too
+// slow to pick up is replaced by the next one. a side with nothing else to do
+// can sleep in the wait calls until the other one moves; the mutex only
+// guards that sleep, the hand-off itself stays lock-free
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() {}
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer &operator=(const TripleBuffer&) = delete;
+
+    // producer side, back() keeps whatever the slot held last time it was
+    // written, so containers in T keep their storage
+    T &back() { return slots[backIndex]; }
+    void publish() {
+        backIndex = middle.exchange(backIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+        wake();
+    }
+    // the last published value has not been acquired yet
+    bool pending() const { return (middle.load(std::memory_order_acquire) & freshBit) != 0; }
+    // until the consumer took the last value or timeout passed, true if it did
+    bool waitAcquired(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, timeout, [this] { return !pending(); });
+    }
+
+    // consumer side, false if nothing was published since the last call and
+    // front() still holds the previous value
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & freshBit)) {
+            return false;
+        }
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+        wake();
+        return true;
+    }
+    T &front() { return slots[frontIndex]; }
+    // until something was published or timeout passed, true if it was
+    bool waitPublished(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, timeout, [this] { return pending(); });
+    }
+
+private:
+    // taking the lock orders the notify after a waiter's check, none is missed
+    void wake() {
+        { std::lock_guard<std::mutex> lock(mutex); }
+        changed.notify_all();
+    }
+
+    static const int indexMask = 3;
+    static const int freshBit = 4;
+
+    T slots[3];
+    int backIndex = 0;
+    int frontIndex = 1;
+    // index of the middle slot, plus freshBit while it holds an unread value
+    std::atomic<int> middle { 2 };
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+#endif
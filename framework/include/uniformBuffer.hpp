@@ -0,0 +1,27 @@
+#ifndef UNIFORMBUFFER_HPP
+#define UNIFORMBUFFER_HPP
+
+#include "glewInc.hpp"
+
+#include <vector>
+
+// std140 uniform block storage bound to a fixed binding point, keeps a copy
+// of the last upload so unchanged data never reaches the driver
+class UniformBuffer {
+public:
+    UniformBuffer() {}
+
+    void create(GLsizeiptr size, GLuint binding);
+    // returns true if the data differed and was uploaded
+    bool update(const void* data, GLsizeiptr size, GLintptr offset = 0);
+
+    GLuint &getID() { return ID; }
+    GLuint getBinding() { return binding; }
+
+private:
+    GLuint ID = 0;
+    GLuint binding = 0;
+    std::vector<unsigned char> shadow;
+};
+
+#endif
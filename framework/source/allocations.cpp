@@ -0,0 +1,31 @@
+#include "allocations.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+AllocationStats allocationStats;
+
+static std::atomic<unsigned long long> allocationCount(0);
+
+unsigned long long heapAllocations() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+// array and nothrow forms forward to these two by default
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
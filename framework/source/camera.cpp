@@ -1,9 +1,6 @@
 #include "camera.hpp"
 #include <cmath>
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/matrix_decompose.hpp>
-
 #include <iostream>
 
 static bool firstFollowing = true;
@@ -36,67 +33,68 @@ void Camera::processMouseMotion(float xoffset, float yoffset) {
     updateCameraVectors();
 }
 
+glm::fmat4 Camera::toRender(const glm::dmat4 &world) const {
+    glm::dmat4 relative = world;
+    relative[3] -= glm::dvec4(position, 0.0);
+    return glm::fmat4(relative);
+}
+
 void Camera::proessKeyboard(m_Camera direction, float cameraSpeed) {
     switch (direction) {
     case m_forwards:
-        position += front * cameraSpeed;
+        position += glm::dvec3(front * cameraSpeed);
     break;
     case m_backwards:
-        position -= front * cameraSpeed;
+        position -= glm::dvec3(front * cameraSpeed);
     break;
     case m_left:
-        position -= right * cameraSpeed; 
+        position -= glm::dvec3(right * cameraSpeed); 
     break;
     case m_right:
-        position += right * cameraSpeed;
+        position += glm::dvec3(right * cameraSpeed);
     break;
     case m_up:
-        position = glm::vec3(position[0], position[1] + cameraSpeed, position[2]);
+        position = glm::dvec3(position[0], position[1] + cameraSpeed, position[2]);
     break;
     case m_down:
-        position = glm::vec3(position[0], position[1] - cameraSpeed, position[2]);
+        position = glm::dvec3(position[0], position[1] - cameraSpeed, position[2]);
     break;
     }
 }
 
-void Camera::follow(glm::fmat4 &mat, f_Camera direction, float size) {
-    glm::mat4 transformation = mat; 
-    glm::vec3 scale;
-    glm::quat rotation;
-    glm::vec3 translation;
-    glm::vec3 skew;
-    glm::vec4 perspective;
-    glm::decompose(transformation, scale, rotation, translation, skew, perspective);
+void Camera::follow(const glm::dmat4 &mat, f_Camera direction, float size) {
+    // straight from the double matrix, a float decompose would round it to kilometres at real scale
+    glm::dvec3 translation = glm::dvec3(mat[3]);
     switch (direction) {
     case f_front:
         yaw = 90.0f;
         pitch = 0.0f;
-        position = glm::vec3(translation[0], translation[1], translation[2] - size);
+        position = glm::dvec3(translation[0], translation[1], translation[2] - size);
     break;
     case f_behind:
         yaw = -90.0f;
         pitch = 0.0f;
-        position = glm::vec3(translation[0], translation[1], translation[2] + size);
+        position = glm::dvec3(translation[0], translation[1], translation[2] + size);
     break;
     case f_left:
         yaw = 360.0f;
         pitch = 0.0f;
-        position = glm::vec3(translation[0] - size, translation[1], translation[2]);
+        position = glm::dvec3(translation[0] - size, translation[1], translation[2]);
     break;
     case f_right:
         yaw = 180.0f;
         pitch = 0.0f;
-        position = glm::vec3(translation[0] + size, translation[1], translation[2]);
+        position = glm::dvec3(translation[0] + size, translation[1], translation[2]);
     break;
     case f_top:
     	yaw = 180.0f;
         pitch = -90.0f;
-        position = glm::vec3(translation[0], translation[1] + size, translation[2]);
+        position = glm::dvec3(translation[0], translation[1] + size, translation[2]);
     break;
     case f_bottom:
         yaw = 360.0f;
         pitch = 90.0f;
-        position = glm::vec3(translation[0], translation[1] - size, translation[2]);
+        position = glm::dvec3(translation[0], translation[1] - size, translation[2]);
     break;
     }
     
@@ -0,0 +1,70 @@
+#include "cubeSphere.hpp"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+glm::vec3 cubeFaceDirection(int face, int x, int y, int faceSize) {
+    // texel centre in [-1, 1], row 0 is t = -1 as in the GL cube map table
+    float s = 2.0f * (x + 0.5f) / faceSize - 1.0f;
+    float t = 2.0f * (y + 0.5f) / faceSize - 1.0f;
+
+    glm::vec3 dir;
+    switch (face) {
+    case 0: dir = glm::vec3( 1.0f,    -t,    -s); break; // +X
+    case 1: dir = glm::vec3(-1.0f,    -t,     s); break; // -X
+    case 2: dir = glm::vec3(    s,  1.0f,     t); break; // +Y
+    case 3: dir = glm::vec3(    s, -1.0f,    -t); break; // -Y
+    case 4: dir = glm::vec3(    s,    -t,  1.0f); break; // +Z
+    default: dir = glm::vec3(  -s,    -t, -1.0f); break; // -Z
+    }
+    return glm::normalize(dir);
+}
+
+// bilinear lookup, wraps around in longitude and clamps at the poles
+static void sampleEquirect(const unsigned char* data, int width, int height, int channels,
+                           float u, float v, unsigned char* out) {
+    float fx = u * width - 0.5f;
+    float fy = v * height - 0.5f;
+    int x0 = (int)floorf(fx);
+    int y0 = (int)floorf(fy);
+    float ax = fx - x0;
+    float ay = fy - y0;
+
+    int x1 = x0 + 1;
+    int y1 = y0 + 1;
+    x0 = (x0 % width + width) % width;
+    x1 = (x1 % width + width) % width;
+    y0 = y0 < 0 ? 0 : (y0 >= height ? height - 1 : y0);
+    y1 = y1 < 0 ? 0 : (y1 >= height ? height - 1 : y1);
+
+    const unsigned char* p00 = data + (y0 * width + x0) * channels;
+    const unsigned char* p10 = data + (y0 * width + x1) * channels;
+    const unsigned char* p01 = data + (y1 * width + x0) * channels;
+    const unsigned char* p11 = data + (y1 * width + x1) * channels;
+
+    for (int c = 0; c < channels; c++) {
+        float top    = p00[c] + (p10[c] - p00[c]) * ax;
+        float bottom = p01[c] + (p11[c] - p01[c]) * ax;
+        out[c] = (unsigned char)(top + (bottom - top) * ay + 0.5f);
+    }
+}
+
+std::vector<unsigned char> reprojectToCubeSphere(const unsigned char* data, int width, int height,
+                                                 int channels, int faceSize) {
+    size_t faceBytes = (size_t)faceSize * faceSize * channels;
+    std::vector<unsigned char> faces(6 * faceBytes);
+
+    for (int face = 0; face < 6; face++) {
+        unsigned char* dst = faces.data() + face * faceBytes;
+        for (int y = 0; y < faceSize; y++) {
+            for (int x = 0; x < faceSize; x++) {
+                glm::vec3 dir = cubeFaceDirection(face, x, y, faceSize);
+                // u grows eastwards seen from outside, v = 0 at the north pole
+                float u = 0.5f + atan2f(dir.x, dir.z) / (2.0f * (float)M_PI);
+                float v = 0.5f - asinf(dir.y) / (float)M_PI;
+                sampleEquirect(data, width, height, channels, u, v, dst + (y * faceSize + x) * channels);
+            }
+        }
+    }
+    return faces;
+}
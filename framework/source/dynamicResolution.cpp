@@ -0,0 +1,84 @@
+#include "dynamicResolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+ResolutionStats resolutionStats;
+
+void GpuTimer::initialize() {
+    glGenQueries(latency, queries);
+}
+
+void GpuTimer::begin() {
+    // every query still in flight, this frame goes unmeasured
+    if (pending[next]) {
+        return;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+    running = true;
+}
+
+void GpuTimer::end() {
+    if (!running) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[next] = true;
+    next = (next + 1) % latency;
+    running = false;
+}
+
+bool GpuTimer::poll(double &ms) {
+    bool found = false;
+    // oldest first, so the newest result is the one that stays in ms
+    for (int i = 0; i < latency; i++) {
+        int slot = (next + i) % latency;
+        if (!pending[slot]) {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &ns);
+        pending[slot] = false;
+        ms = ns / 1.0e6;
+        found = true;
+    }
+    return found;
+}
+
+float DynamicResolution::update(double frameMs, float targetMs) {
+    if (frameMs <= 0.0 || targetMs <= 0.0f) {
+        return scale;
+    }
+    // positive with headroom; the cost goes with the pixel count, the square
+    // of the scale, so the error is taken on the square root of the ratio
+    float error = std::sqrt(targetMs / (float)frameMs) - 1.0f;
+    // small wobbles of the timer are not worth a resize
+    if (std::fabs(error) < 0.04f) {
+        error = 0.0f;
+    }
+    // velocity form, the output is a change of scale; clamping it is all the
+    // anti-windup the integral term needs
+    float change = kp * (error - lastError) + ki * error + kd * (error - 2.0f * lastError + olderError);
+    olderError = lastError;
+    lastError = error;
+    target = std::clamp(target + change, minScale, maxScale);
+
+    // drops as soon as the output is half a step lower, climbs only once it
+    // is well past the next step, so it does not toggle between two sizes
+    if (target < scale - 0.5f * step || target > scale + 1.5f * step || target == maxScale) {
+        scale = std::clamp(std::round(target / step) * step, minScale, maxScale);
+    }
+    return scale;
+}
+
+void DynamicResolution::reset() {
+    lastError = 0.0f;
+    olderError = 0.0f;
+    target = 1.0f;
+    scale = 1.0f;
+}
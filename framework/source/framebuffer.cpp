@@ -1,6 +1,7 @@
 #include "framebuffer.hpp"
 
 #include "utils.hpp"
+#include "glState.hpp"
 #include <iostream>
 
 Framebuffer::Framebuffer() {
@@ -52,9 +53,9 @@ Framebuffer::Framebuffer() {
 }
 
 void Framebuffer::bind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+    GLState::get().bindFramebuffer(hdrFBO);
 }
 
 void Framebuffer::unbind() {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::get().bindFramebuffer(0);
 }
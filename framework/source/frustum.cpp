@@ -0,0 +1,44 @@
+#include "frustum.hpp"
+
+CullingStats cullingStats;
+
+void Frustum::extract(const glm::mat4 &m) {
+    // Gribb / Hartmann, rows of the matrix combined per clip plane
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0; // left
+    planes[1] = row3 - row0; // right
+    planes[2] = row3 + row1; // bottom
+    planes[3] = row3 - row1; // top
+    // with the reversed infinite projection row 2 is (0, 0, 0, near): the
+    // "far" plane below is the near plane and "near" a looser copy of it
+    planes[4] = row3 + row2; // near
+    planes[5] = row3 - row2; // far
+
+    // unit normals so the plane distance can be compared against a radius
+    for (glm::vec4 &plane : planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+bool Frustum::testSphere(const glm::vec3 &center, float radius) const {
+    for (const glm::vec4 &plane : planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int Frustum::testSpheres4(float4 x, float4 y, float4 z, float4 radius) const {
+    float4 outside = splat(0.0f);
+    float4 negative = splat(0.0f) - radius;
+    for (const glm::vec4 &plane : planes) {
+        float4 distance = x * splat(plane.x) + y * splat(plane.y) + z * splat(plane.z) + splat(plane.w);
+        outside = or4(outside, less4(distance, negative));
+    }
+    return ~mask4(outside) & 0xF;
+}
@@ -0,0 +1,272 @@
+#include "geometryArena.hpp"
+#include "glState.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+void FreeList::reset(GLuint aCapacity) {
+    capacity = aCapacity;
+    used = 0;
+    blocks.clear();
+    if (capacity > 0) {
+        blocks.push_back(Block{ 0, capacity });
+    }
+}
+
+long long FreeList::allocate(GLuint count) {
+    if (count == 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (blocks[i].count >= count) {
+            GLuint offset = blocks[i].offset;
+            blocks[i].offset += count;
+            blocks[i].count -= count;
+            if (blocks[i].count == 0) {
+                blocks.erase(blocks.begin() + i);
+            }
+            used += count;
+            return offset;
+        }
+    }
+    return -1;
+}
+
+void FreeList::release(GLuint offset, GLuint count) {
+    if (count == 0) {
+        return;
+    }
+    used -= count;
+    // blocks stay sorted by offset, so only the two neighbours can merge
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), offset,
+                               [](const Block& block, GLuint value) { return block.offset < value; });
+    it = blocks.insert(it, Block{ offset, count });
+    if (it + 1 != blocks.end() && it->offset + it->count == (it + 1)->offset) {
+        it->count += (it + 1)->count;
+        blocks.erase(it + 1);
+    }
+    if (it != blocks.begin() && (it - 1)->offset + (it - 1)->count == it->offset) {
+        (it - 1)->count += it->count;
+        blocks.erase(it);
+    }
+}
+
+void FreeList::grow(GLuint newCapacity) {
+    if (newCapacity <= capacity) {
+        return;
+    }
+    GLuint old = capacity;
+    capacity = newCapacity;
+    used += newCapacity - old;
+    release(old, newCapacity - old);
+}
+
+GLuint FreeList::getFragmented() const {
+    GLuint free = capacity - used;
+    // the block running up to capacity is room to grow into, not a hole
+    if (!blocks.empty() && blocks.back().offset + blocks.back().count == capacity) {
+        free -= blocks.back().count;
+    }
+    return free;
+}
+
+GLuint GeometryArena::getVertexArray() {
+    if (vertexArrays.empty()) {
+        createVertexArray();
+    }
+    return vertexArrays.front();
+}
+
+GLuint GeometryArena::createVertexArray() {
+    if (vertexBuffer == 0) {
+        reserve(1 << 16, 1 << 17);
+    }
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    vertexArrays.push_back(vao);
+    describe(vao);
+    return vao;
+}
+
+void GeometryArena::describe(GLuint vao) {
+    GLState::get().bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    // the element buffer binding is vao state
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// moves the buffers to at least the given sizes, live data keeps its offsets
+void GeometryArena::reserve(GLuint vertices, GLuint indices) {
+    GLuint oldVertices = vertexSpace.getCapacity();
+    GLuint oldIndices = indexSpace.getCapacity();
+    if (vertexBuffer != 0 && vertices <= oldVertices && indices <= oldIndices) {
+        return;
+    }
+    vertices = std::max(vertices, oldVertices);
+    indices = std::max(indices, oldIndices);
+
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertices * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+    if (vertexBuffer != 0 && oldVertices > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)oldVertices * sizeof(Vertex));
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indices * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+    if (indexBuffer != 0 && oldIndices > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, indexBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)oldIndices * sizeof(GLuint));
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (vertexBuffer != 0) {
+        glDeleteBuffers(1, &vertexBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+        vertexSpace.grow(vertices);
+        indexSpace.grow(indices);
+    } else {
+        vertexSpace.reset(vertices);
+        indexSpace.reset(indices);
+    }
+    vertexBuffer = buffers[0];
+    indexBuffer = buffers[1];
+    for (GLuint vao : vertexArrays) {
+        describe(vao);
+    }
+}
+
+int GeometryArena::allocate(const std::vector<Vertex> &vertices, const std::vector<GLuint> &indices) {
+    getVertexArray();
+
+    GLuint vertexCount = (GLuint)vertices.size();
+    GLuint indexCount = (GLuint)indices.size();
+    long long baseVertex = vertexSpace.allocate(vertexCount);
+    long long firstIndex = indexSpace.allocate(indexCount);
+    if (baseVertex < 0 || firstIndex < 0) {
+        // give back what fit and retry once the buffers have doubled
+        if (baseVertex >= 0) {
+            vertexSpace.release((GLuint)baseVertex, vertexCount);
+        }
+        if (firstIndex >= 0) {
+            indexSpace.release((GLuint)firstIndex, indexCount);
+        }
+        reserve(std::max(vertexSpace.getCapacity() * 2, vertexSpace.getCapacity() + vertexCount),
+                std::max(indexSpace.getCapacity() * 2, indexSpace.getCapacity() + indexCount));
+        baseVertex = vertexSpace.allocate(vertexCount);
+        firstIndex = indexSpace.allocate(indexCount);
+    }
+
+    MeshRange range;
+    range.baseVertex = (GLint)baseVertex;
+    range.vertexCount = vertexCount;
+    range.firstIndex = (GLuint)firstIndex;
+    range.indexCount = (GLsizei)indexCount;
+    range.live = true;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)baseVertex * sizeof(Vertex), (GLsizeiptr)vertexCount * sizeof(Vertex), vertices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)firstIndex * sizeof(GLuint), (GLsizeiptr)indexCount * sizeof(GLuint), indices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // released slots are reused so handles stay small
+    for (size_t i = 0; i < ranges.size(); i++) {
+        if (!ranges[i].live) {
+            ranges[i] = range;
+            return (int)i;
+        }
+    }
+    ranges.push_back(range);
+    return (int)ranges.size() - 1;
+}
+
+void GeometryArena::release(int handle) {
+    if (handle < 0 || handle >= (int)ranges.size() || !ranges[handle].live) {
+        std::cerr << "ERROR::GEOMETRY_ARENA::RELEASE OF UNKNOWN MESH " << handle << std::endl;
+        return;
+    }
+    MeshRange& range = ranges[handle];
+    vertexSpace.release((GLuint)range.baseVertex, range.vertexCount);
+    indexSpace.release(range.firstIndex, (GLuint)range.indexCount);
+    range.live = false;
+
+    if (fragmented(vertexSpace) || fragmented(indexSpace)) {
+        compact();
+    }
+}
+
+bool GeometryArena::fragmented(const FreeList &space) const {
+    if (space.getCapacity() == 0) {
+        return false;
+    }
+    return space.getHoles() > maxHoles || space.getFragmented() > maxFragmented * space.getCapacity();
+}
+
+void GeometryArena::compact() {
+    if (vertexBuffer == 0 || (vertexSpace.getHoles() <= 1 && indexSpace.getHoles() <= 1)) {
+        return;
+    }
+    GLuint vertexCapacity = vertexSpace.getCapacity();
+    GLuint indexCapacity = indexSpace.getCapacity();
+
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCapacity * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer);
+    GLuint vertexEnd = 0;
+    for (MeshRange& range : ranges) {
+        if (range.live) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)range.baseVertex * sizeof(Vertex),
+                                (GLintptr)vertexEnd * sizeof(Vertex), (GLsizeiptr)range.vertexCount * sizeof(Vertex));
+            range.baseVertex = (GLint)vertexEnd;
+            vertexEnd += range.vertexCount;
+        }
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, indexBuffer);
+    GLuint indexEnd = 0;
+    for (MeshRange& range : ranges) {
+        if (range.live) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)range.firstIndex * sizeof(GLuint),
+                                (GLintptr)indexEnd * sizeof(GLuint), (GLsizeiptr)range.indexCount * sizeof(GLuint));
+            range.firstIndex = indexEnd;
+            indexEnd += (GLuint)range.indexCount;
+        }
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+    vertexBuffer = buffers[0];
+    indexBuffer = buffers[1];
+
+    // everything in front is live now, one free block behind it
+    vertexSpace.reset(vertexCapacity);
+    vertexSpace.allocate(vertexEnd);
+    indexSpace.reset(indexCapacity);
+    indexSpace.allocate(indexEnd);
+    for (GLuint vao : vertexArrays) {
+        describe(vao);
+    }
+}
+
+void GeometryArena::draw(int handle, GLenum mode, GLsizei instances) const {
+    const MeshRange& range = ranges[handle];
+    glDrawElementsInstancedBaseVertex(mode, range.indexCount, GL_UNSIGNED_INT,
+                                      (void*)((size_t)range.firstIndex * sizeof(GLuint)), instances, range.baseVertex);
+}
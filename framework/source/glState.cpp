@@ -0,0 +1,105 @@
+#include "glState.hpp"
+
+GLStateStats glStateStats;
+GLStateStats lastGLStateStats;
+
+// no real object or enum has this value, so the first call after invalidate always goes through
+static const GLuint unknown = 0xFFFFFFFF;
+
+void GLState::invalidate() {
+    program = unknown;
+    vao = unknown;
+    framebuffer = unknown;
+    depth = unknown;
+    activeUnit = unknown;
+    for (unsigned int i = 0; i < maxUnits; i++) {
+        textures2D[i] = unknown;
+        texturesCube[i] = unknown;
+    }
+    view[0] = view[1] = view[2] = view[3] = -1;
+    for (unsigned int i = 0; i < maxBindings; i++) {
+        rangeBuffers[i] = unknown;
+        rangeOffsets[i] = -1;
+    }
+}
+
+bool GLState::changed(bool differs) {
+    if (differs) {
+        glStateStats.issued++;
+    } else {
+        glStateStats.filtered++;
+    }
+    return differs;
+}
+
+void GLState::useProgram(GLuint aProgram) {
+    if (changed(program != aProgram)) {
+        program = aProgram;
+        glUseProgram(program);
+    }
+}
+
+void GLState::bindVertexArray(GLuint aVao) {
+    if (changed(vao != aVao)) {
+        vao = aVao;
+        glBindVertexArray(vao);
+    }
+}
+
+void GLState::bindTexture(unsigned int unit, GLenum target, GLuint texture) {
+    GLuint* slot = nullptr;
+    if (unit < maxUnits) {
+        slot = target == GL_TEXTURE_CUBE_MAP ? &texturesCube[unit] : &textures2D[unit];
+    }
+    if (!changed(slot == nullptr || *slot != texture)) {
+        return;
+    }
+    if (activeUnit != unit) {
+        activeUnit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glStateStats.issued++;
+    }
+    glBindTexture(target, texture);
+    if (slot) {
+        *slot = texture;
+    }
+}
+
+void GLState::activeTexture(unsigned int unit) {
+    if (changed(activeUnit != unit)) {
+        activeUnit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void GLState::bindFramebuffer(GLuint aFramebuffer) {
+    if (changed(framebuffer != aFramebuffer)) {
+        framebuffer = aFramebuffer;
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+void GLState::depthFunc(GLenum func) {
+    if (changed(depth != func)) {
+        depth = func;
+        glDepthFunc(depth);
+    }
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (changed(view[0] != x || view[1] != y || view[2] != width || view[3] != height)) {
+        view[0] = x; view[1] = y; view[2] = width; view[3] = height;
+        glViewport(x, y, width, height);
+    }
+}
+
+void GLState::bindBufferRange(GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    bool tracked = index < maxBindings;
+    if (changed(!tracked || rangeBuffers[index] != buffer || rangeOffsets[index] != offset)) {
+        if (tracked) {
+            rangeBuffers[index] = buffer;
+            rangeOffsets[index] = offset;
+        }
+        glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+    }
+}
@@ -0,0 +1,183 @@
+#include "hiZ.hpp"
+#include "glState.hpp"
+#include "geometryArena.hpp"
+#include "reversedZ.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// coarsest width the readback may have, keeps the copy and the cpu loops small
+static const int maxReadWidth = 128;
+
+void HiZ::initialize(int aWidth, int aHeight) {
+    width = aWidth;
+    height = aHeight;
+    int baseWidth = std::max(1, width / 2);
+    int baseHeight = std::max(1, height / 2);
+    levels = 1;
+    while ((baseWidth >> levels) > 0 || (baseHeight >> levels) > 0) {
+        levels++;
+    }
+
+    shader = Shader("hiZ");
+    shader.createShader();
+    sourceUniform = shader.getUniform<int>("source");
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    for (int level = 0; level < levels; level++) {
+        glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, std::max(1, baseWidth >> level), std::max(1, baseHeight >> level),
+                     0, GL_RED, GL_FLOAT, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+    framebuffers.resize(levels);
+    glGenFramebuffers(levels, framebuffers.data());
+    for (int level = 0; level < levels; level++) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[level]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, level);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "ERROR::HIZ::FRAMEBUFFER NOT COMPLETE::LEVEL " << level << std::endl;
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    readLevel = 0;
+    while (readLevel < levels - 1 && std::max(1, baseWidth >> readLevel) > maxReadWidth) {
+        readLevel++;
+    }
+    readWidth = std::max(1, baseWidth >> readLevel);
+    readHeight = std::max(1, baseHeight >> readLevel);
+    readDepth.assign((size_t)readWidth * readHeight, 0.0f);
+    for (Readback& readback : readbacks) {
+        glGenBuffers(1, &readback.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)readDepth.size() * sizeof(float), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void HiZ::build(GLuint depth, const glm::dmat4 &aView, const glm::mat4 &aProjection, const glm::ivec2 &aExtent) {
+    GLState& state = GLState::get();
+    glDisable(GL_DEPTH_TEST);
+    shader.use();
+    shader.set(sourceUniform, 0);
+    // the triangle comes from gl_VertexID, any vao will do
+    state.bindVertexArray(GeometryArena::get().getVertexArray());
+
+    for (int level = 0; level < levels; level++) {
+        state.bindTexture(0, GL_TEXTURE_2D, level == 0 ? depth : texture);
+        if (level > 0) {
+            // the sampler only sees the level below the one being written,
+            // so reading and writing the same texture is no feedback loop
+            state.activeTexture(0);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+        }
+        state.bindFramebuffer(framebuffers[level]);
+        state.viewport(0, 0, std::max(1, (width / 2) >> level), std::max(1, (height / 2) >> level));
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    state.activeTexture(0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glEnable(GL_DEPTH_TEST);
+
+    view = aView;
+    projection = aProjection;
+    extent = aExtent;
+    built = true;
+
+    // both pbos still in flight, this frame's pyramid is not read back
+    Readback& readback = readbacks[nextReadback];
+    if (readback.fence != 0) {
+        return;
+    }
+    state.bindFramebuffer(framebuffers[readLevel]);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    glReadPixels(0, 0, readWidth, readHeight, GL_RED, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.view = view;
+    readback.projection = projection;
+    readback.extent = extent;
+    nextReadback ^= 1;
+}
+
+void HiZ::poll() {
+    // oldest first, so the newest finished copy is the one that stays
+    for (int i = 0; i < 2; i++) {
+        Readback& readback = readbacks[(nextReadback + i) & 1];
+        if (readback.fence == 0) {
+            continue;
+        }
+        GLenum status = glClientWaitSync(readback.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        glDeleteSync(readback.fence);
+        readback.fence = 0;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)readDepth.size() * sizeof(float), GL_MAP_READ_BIT);
+        if (data) {
+            std::memcpy(readDepth.data(), data, readDepth.size() * sizeof(float));
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            readView = readback.view;
+            readProjection = readback.projection;
+            readExtent = readback.extent;
+            readValid = true;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+}
+
+bool HiZ::occluded(const glm::dvec3 &center, float radius) const {
+    if (!readValid) {
+        return false;
+    }
+    glm::vec3 c = glm::vec3(readView * glm::dvec4(center, 1.0));
+    float nearest = -c.z - radius;
+    // reaches the camera plane, the rect would be unbounded
+    if (nearest <= 0.0f) {
+        return false;
+    }
+    float farthest = -c.z + radius;
+
+    // the view-space box around the sphere, each edge divided by whichever
+    // depth pushes it further out, contains the sphere's projection
+    const glm::mat4& p = readProjection;
+    float left   = (c.x - radius) / (c.x - radius < 0.0f ? nearest : farthest) * p[0][0];
+    float right  = (c.x + radius) / (c.x + radius > 0.0f ? nearest : farthest) * p[0][0];
+    float bottom = (c.y - radius) / (c.y - radius < 0.0f ? nearest : farthest) * p[1][1];
+    float top    = (c.y + radius) / (c.y + radius > 0.0f ? nearest : farthest) * p[1][1];
+    // off screen, that is the frustum test's call
+    if (left >= 1.0f || right <= -1.0f || bottom >= 1.0f || top <= -1.0f) {
+        return false;
+    }
+
+    // depth buffer pixels first, then the cells of the read level that cover them
+    int shift = readLevel + 1;
+    int x0 = std::min((int)((std::max(left, -1.0f) * 0.5f + 0.5f) * readExtent.x) >> shift, readWidth - 1);
+    int x1 = std::min((int)((std::min(right, 1.0f) * 0.5f + 0.5f) * readExtent.x) >> shift, readWidth - 1);
+    int y0 = std::min((int)((std::max(bottom, -1.0f) * 0.5f + 0.5f) * readExtent.y) >> shift, readHeight - 1);
+    int y1 = std::min((int)((std::min(top, 1.0f) * 0.5f + 0.5f) * readExtent.y) >> shift, readHeight - 1);
+
+    // reversed-z, anything at or beyond the sphere's front shows through
+    float depth = reversedDepth(nearest, p[3][2]);
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            if (readDepth[(size_t)y * readWidth + x] <= depth) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
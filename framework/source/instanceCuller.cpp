@@ -0,0 +1,175 @@
+#include "instanceCuller.hpp"
+#include "glState.hpp"
+
+#include <cstddef>
+
+CullPath InstanceCuller::detect() {
+    if (GLEW_VERSION_4_3) {
+        return CULL_COMPUTE;
+    }
+    // the query buffer keeps the survivor count on the gpu, without it the
+    // count would have to be read back and the cpu path is just as good
+    if (GLEW_VERSION_3_2 && GLEW_ARB_draw_indirect && GLEW_ARB_query_buffer_object) {
+        return CULL_FEEDBACK;
+    }
+    return CULL_CPU;
+}
+
+const char* InstanceCuller::getPathName() {
+    switch (path) {
+    case CULL_COMPUTE:  return "compute";
+    case CULL_FEEDBACK: return "transform feedback";
+    default:            return "cpu";
+    }
+}
+
+void InstanceCuller::initialize(CullPath aPath) {
+    path = aPath;
+    if (path == CULL_CPU) {
+        return;
+    }
+
+    if (path == CULL_COMPUTE) {
+        shader = Shader("cullCompute", { "OCCLUSION", "RETEST" });
+    } else {
+        shader = Shader("cullFeedback");
+        shader.setFeedbackVaryings({ "outInstance" });
+    }
+    shader.createShader();
+    planesUniform = shader.getUniform<glm::fvec4>("planes");
+    countUniform = shader.getUniform<int>("count");
+    radiusUniform = shader.getUniform<float>("meshRadius");
+    hiZUniform = shader.getUniform<int>("hiZ");
+    hiZViewUniform = shader.getUniform<glm::fmat4>("hiZView");
+    hiZProjectionUniform = shader.getUniform<glm::fmat4>("hiZProjection");
+    hiZSizeUniform = shader.getUniform<glm::ivec2>("hiZSize");
+    hiZLevelsUniform = shader.getUniform<int>("hiZLevels");
+
+    glGenBuffers(1, &output);
+    glGenBuffers(1, &commands);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, 2 * sizeof(DrawElementsIndirectCommand) + sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    if (path == CULL_COMPUTE) {
+        glGenBuffers(1, &occluded);
+    }
+    if (path == CULL_FEEDBACK) {
+        glGenVertexArrays(1, &sourceVAO);
+        glGenQueries(1, &query);
+    }
+}
+
+void InstanceCuller::resize(int aCapacity) {
+    capacity = aCapacity > 0 ? aCapacity : 0;
+    if (path == CULL_CPU) {
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, output);
+    // at least one element, zero sized buffers cannot be bound as storage
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(capacity > 0 ? capacity : 1) * sizeof(glm::vec4), nullptr, GL_DYNAMIC_COPY);
+    if (path == CULL_COMPUTE) {
+        glBindBuffer(GL_ARRAY_BUFFER, occluded);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(capacity > 0 ? capacity : 1) * sizeof(glm::vec4), nullptr, GL_DYNAMIC_COPY);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// the pyramid, and the matrices it was drawn with, for the OCCLUSION variants
+void InstanceCuller::setHiZ(const HiZ &hiZ) {
+    GLState::get().bindTexture(0, GL_TEXTURE_2D, hiZ.getTexture());
+    shader.set(hiZUniform, 0);
+    shader.set(hiZViewUniform, hiZ.getView());
+    shader.set(hiZProjectionUniform, hiZ.getProjection());
+    shader.set(hiZSizeUniform, hiZ.getSize());
+    shader.set(hiZLevelsUniform, hiZ.getLevels());
+}
+
+void InstanceCuller::cull(GLuint instances, GLintptr offset, int count, const Frustum &frustum, float meshRadius,
+                          const MeshRange &mesh, const HiZ* hiZ) {
+    retesting = false;
+    if (path == CULL_CPU) {
+        return;
+    }
+    count = count < capacity ? count : capacity;
+
+    // instance counts are filled in on the gpu below
+    DrawElementsIndirectCommand command = { (GLuint)mesh.indexCount, 0, mesh.firstIndex, mesh.baseVertex, 0 };
+    DrawElementsIndirectCommand reset[2] = { command, command };
+    GLuint occludedCount = 0;
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(reset), reset);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, sizeof(reset), sizeof(occludedCount), &occludedCount);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    if (count == 0) {
+        return;
+    }
+
+    retesting = path == CULL_COMPUTE && hiZ && hiZ->isBuilt();
+    shader.setVariant({ retesting, false });
+    shader.use();
+    shader.set(planesUniform, frustum.getPlanes(), 6);
+    shader.set(countUniform, count);
+    shader.set(radiusUniform, meshRadius);
+
+    if (path == CULL_COMPUTE) {
+        if (retesting) {
+            setHiZ(*hiZ);
+        }
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, instances, offset, (GLsizeiptr)count * sizeof(glm::vec4));
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, output);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commands);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, occluded);
+        glDispatchCompute((count + 255) / 256, 1, 1);
+        dispatched = count;
+        // the draw reads the command and the compacted list as vertex attributes,
+        // retest() copies the first count into the second command
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+        return;
+    }
+
+    GLState::get().bindVertexArray(sourceVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instances);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)offset);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, output);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, query);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, count);
+    glEndTransformFeedback();
+    glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+    // with a query buffer bound the result is written by the gpu, nothing waits here
+    glBindBuffer(GL_QUERY_BUFFER, commands);
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT, (GLuint*)offsetof(DrawElementsIndirectCommand, instanceCount));
+    glBindBuffer(GL_QUERY_BUFFER, 0);
+}
+
+void InstanceCuller::retest(const HiZ &hiZ, float meshRadius) {
+    if (!retesting) {
+        return;
+    }
+    // the second command draws from where the first one's instances end
+    glBindBuffer(GL_COPY_READ_BUFFER, commands);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, commands);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offsetof(DrawElementsIndirectCommand, instanceCount),
+                        sizeof(DrawElementsIndirectCommand) + offsetof(DrawElementsIndirectCommand, baseInstance), sizeof(GLuint));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    shader.setVariant({ true, true });
+    shader.use();
+    shader.set(radiusUniform, meshRadius);
+    setHiZ(hiZ);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, output);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commands);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, occluded);
+    // the occluded count only exists on the gpu, the groups past it return at once
+    glDispatchCompute((dispatched + 255) / 256, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
@@ -0,0 +1,81 @@
+#include "jobs.hpp"
+
+Jobs::Jobs() {
+    next = 0;
+    unsigned int cores = std::thread::hardware_concurrency();
+    for (unsigned int i = 1; i < cores; i++) {
+        workers.emplace_back(&Jobs::workerLoop, this);
+    }
+}
+
+Jobs::~Jobs() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void Jobs::parallelFor(int count, const std::function<void(int, int)> &job) {
+    if (count <= 0) {
+        return;
+    }
+    if (workers.empty()) {
+        job(0, count);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    current = &job;
+    total = count;
+    // a few chunks per thread so uneven rows still balance out
+    chunk = count / (int(getThreadCount()) * 4);
+    if (chunk < 1) {
+        chunk = 1;
+    }
+    next = 0;
+    busy = (unsigned int)workers.size();
+    generation++;
+    lock.unlock();
+    wake.notify_all();
+
+    runChunks();
+
+    lock.lock();
+    done.wait(lock, [this] { return busy == 0; });
+    current = nullptr;
+}
+
+void Jobs::workerLoop() {
+    unsigned int seen = 0;
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [&] { return quit || generation != seen; });
+        if (quit) {
+            return;
+        }
+        seen = generation;
+        lock.unlock();
+
+        runChunks();
+
+        lock.lock();
+        if (--busy == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+void Jobs::runChunks() {
+    for (;;) {
+        int begin = next.fetch_add(chunk);
+        if (begin >= total) {
+            break;
+        }
+        int end = begin + chunk < total ? begin + chunk : total;
+        (*current)(begin, end);
+    }
+}
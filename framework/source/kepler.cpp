@@ -0,0 +1,41 @@
+#include "kepler.hpp"
+
+#include <cmath>
+
+static const double pi = 3.14159265358979323846;
+
+void orbitAxes(const OrbitalElements &elements, glm::dvec3 &p, glm::dvec3 &q) {
+    double e = elements.eccentricity;
+    double a = elements.semiMajorAxis;
+    double b = a * std::sqrt(1.0 - e * e);
+    double cO = std::cos(elements.ascendingNode), sO = std::sin(elements.ascendingNode);
+    double cw = std::cos(elements.periapsis), sw = std::sin(elements.periapsis);
+    double ci = std::cos(elements.inclination), si = std::sin(elements.inclination);
+    // perifocal -> ecliptic, then ecliptic (x, y, z) -> scene (y, z, x)
+    glm::dvec3 P(cO * cw - sO * sw * ci, sO * cw + cO * sw * ci, sw * si);
+    glm::dvec3 Q(-cO * sw - sO * cw * ci, -sO * sw + cO * cw * ci, cw * si);
+    p = a * glm::dvec3(P.y, P.z, P.x);
+    q = b * glm::dvec3(Q.y, Q.z, Q.x);
+}
+
+double eccentricAnomaly(double meanAnomaly, double eccentricity) {
+    double M = std::fmod(meanAnomaly, 2.0 * pi);
+    double e = eccentricity;
+    // starting at pi keeps newton from overshooting for eccentric orbits
+    double E = e > 0.8 ? pi : M;
+    for (int i = 0; i < 8; i++) {
+        double d = (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
+        E -= d;
+        if (std::fabs(d) < 1e-12) {
+            break;
+        }
+    }
+    return E;
+}
+
+glm::dvec3 orbitPosition(const OrbitalElements &elements, double meanAnomaly) {
+    glm::dvec3 p, q;
+    orbitAxes(elements, p, q);
+    double E = eccentricAnomaly(meanAnomaly, elements.eccentricity);
+    return (std::cos(E) - elements.eccentricity) * p + std::sin(E) * q;
+}
@@ -0,0 +1,43 @@
+#include "material.hpp"
+#include "glState.hpp"
+
+#include <iostream>
+
+UniformBuffer Material::storage;
+GLintptr Material::stride = 0;
+unsigned int Material::capacity = 0;
+unsigned int Material::count = 0;
+
+void Material::initialize(unsigned int aCapacity) {
+    // range binds have to start on the driver's offset alignment
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    stride = ((GLintptr)sizeof(MaterialData) + alignment - 1) / alignment * alignment;
+
+    capacity = aCapacity;
+    count = 0;
+    storage.create(stride * capacity, materialBinding);
+}
+
+void Material::create() {
+    if (count >= capacity) {
+        std::cerr << "ERROR::MATERIAL::OUT OF SLOTS (" << capacity << ")" << std::endl;
+        return;
+    }
+    offset = stride * count++;
+    storage.update(&data, sizeof(MaterialData), offset);
+}
+
+bool Material::update(const MaterialData& aData) {
+    data = aData;
+    if (offset < 0) {
+        return false;
+    }
+    return storage.update(&data, sizeof(MaterialData), offset);
+}
+
+void Material::bind() const {
+    if (offset >= 0) {
+        GLState::get().bindBufferRange(materialBinding, storage.getID(), offset, sizeof(MaterialData));
+    }
+}
@@ -1,9 +1,13 @@
 #include "model.hpp"
 #include "utils.hpp"
+#include "glState.hpp"
 
 #include <sstream>
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <array>
+#include <map>
 
 vertexInfo split(const std::string& str) {
     std::istringstream iss(str);
@@ -71,6 +75,7 @@ void Model::sort() {
 
             out_vertices.push_back(vertex);
             out_textures.push_back(uv);
+            boundingRadius = std::max(boundingRadius, glm::length(vertex));
             out_normals.push_back(normal);
         }
     } else {
@@ -157,72 +162,91 @@ void Model::parseObj(const std::string path) {
     sort();
 }
 
-void Model::setGeometry(GLenum draw_mode) {
-    glGenVertexArrays(1, &model_object.VAO);
-    glBindVertexArray(model_object.VAO);
-     
-    if (gotPosition && gotTexture && gotNormal && gotIndex) {
-        glGenBuffers(1, &model_object.VBO);
-	    glBindBuffer(GL_ARRAY_BUFFER, model_object.VBO);
-        glBufferData(GL_ARRAY_BUFFER, out_vertices.size() * sizeof(glm::vec3), &out_vertices[0], GL_STATIC_DRAW);
+void uploadMesh(modelObject &object, const std::vector<Vertex> &vertices, const std::vector<GLuint> &indices, GLenum draw_mode) {
+    GeometryArena& arena = GeometryArena::get();
+    // a model given new geometry hands its old range back first
+    if (object.mesh >= 0) {
+        arena.release(object.mesh);
+    }
+    object.mesh = arena.allocate(vertices, indices);
+    object.VAO = arena.getVertexArray();
+    object.draw_mode = draw_mode;
+    object.num_elements = (GLsizei)indices.size();
+}
 
-        glGenBuffers(1, &model_object.TBO);
-	    glBindBuffer(GL_ARRAY_BUFFER, model_object.TBO);
-        glBufferData(GL_ARRAY_BUFFER, out_textures.size() * sizeof(glm::vec2), &out_textures[0], GL_STATIC_DRAW);
+void drawMesh(const modelObject &object, GLsizei instances) {
+    GLState::get().bindVertexArray(object.VAO);
+    GeometryArena::get().draw(object.mesh, object.draw_mode, instances);
+}
 
-	    glGenBuffers(1, &model_object.NBO);
-	    glBindBuffer(GL_ARRAY_BUFFER, model_object.NBO);
-        glBufferData(GL_ARRAY_BUFFER, out_normals.size() * sizeof(glm::vec3), &out_normals[0], GL_STATIC_DRAW);
-    }
-    else {
+// the obj data is unrolled per face corner, equal corners are merged into one indexed vertex
+void Model::setGeometry(GLenum draw_mode) {
+    if (!(gotPosition && gotTexture && gotNormal && gotIndex)) {
         std::cerr << "ERROR::MODEL::VERTEX BUFFER" << std::endl;
+        return;
     }
-    model_object.num_elements = out_vertices.size();
-    model_object.draw_mode = draw_mode;
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+    std::map<std::array<float, 8>, GLuint> unique;
+    for (size_t i = 0; i < out_vertices.size(); i++) {
+        Vertex vertex;
+        vertex.position = out_vertices[i];
+        vertex.texCoord = out_textures[i];
+        vertex.normal = out_normals[i];
+        std::array<float, 8> key = { vertex.position.x, vertex.position.y, vertex.position.z,
+                                     vertex.texCoord.x, vertex.texCoord.y,
+                                     vertex.normal.x, vertex.normal.y, vertex.normal.z };
+        auto it = unique.find(key);
+        if (it == unique.end()) {
+            it = unique.emplace(key, (GLuint)vertices.size()).first;
+            vertices.push_back(vertex);
+        }
+        indices.push_back(it->second);
+    }
+    uploadMesh(model_object, vertices, indices, draw_mode);
 }
 
+// the arena describes the shared layout once, this only binds the mesh's vao
 void Model::setVertexAttributes() {
-    glBindVertexArray(model_object.VAO);
-    if (gotIndex && gotNormal && gotTexture && gotPosition) {
-        glEnableVertexAttribArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, model_object.VBO);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-        glEnableVertexAttribArray(1);
-        glBindBuffer(GL_ARRAY_BUFFER, model_object.TBO);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
-        glEnableVertexAttribArray(2);
-        glBindBuffer(GL_ARRAY_BUFFER, model_object.NBO);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    } else {
-        std::cerr << "ERROR::MODEL::NOT ENOUGH VERTEX ATTRIBUTES" << std::endl;
-    }
-    
-    model_object.num_elements = out_vertices.size();
+    GLState::get().bindVertexArray(model_object.VAO);
 }
 
 void Model::draw() {
-    glBindVertexArray(model_object.VAO);
-    glDrawArrays(model_object.draw_mode, 0, model_object.num_elements);
+    drawMesh(model_object);
+}
 
-    if (gotPosition && gotTexture && gotNormal && gotIndex) {
-        glDisableVertexAttribArray(1);
-        glDisableVertexAttribArray(2);
-        glDisableVertexAttribArray(3);
-    } else {
-        std::cerr << "ERROR::MODEL::DISABLE VERTEX ATTRIBUTES" << std::endl;
+// per-instance vec4 at attribute 3 needs a vao of its own, the shared one stays untouched
+void Model::setInstanceBuffer(GLuint buffer, GLintptr offset) {
+    if (model_object.VAO == GeometryArena::get().getVertexArray()) {
+        model_object.VAO = GeometryArena::get().createVertexArray();
     }
+    GLState::get().bindVertexArray(model_object.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)offset);
+    glVertexAttribDivisor(3, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void Model::instanceDraw(int amount) {
-    glBindVertexArray(model_object.VAO);
-    glDrawElementsInstanced(model_object.draw_mode, model_object.num_elements, GL_UNSIGNED_INT, 0, amount);
+    drawMesh(model_object, amount);
+}
 
-    if (gotPosition && gotTexture && gotNormal && gotIndex) {
-        glDisableVertexAttribArray(1);
-        glDisableVertexAttribArray(2);
-        glDisableVertexAttribArray(3);
+void Model::indirectDraw(GLuint commands, GLintptr offset) {
+    GLState::get().bindVertexArray(model_object.VAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands);
+    if (GLEW_ARB_multi_draw_indirect) {
+        glMultiDrawElementsIndirect(model_object.draw_mode, GL_UNSIGNED_INT, (void*)offset, 1, 0);
     } else {
-        std::cerr << "ERROR::MODEL::DISABLE VERTEX ATTRIBUTES" << std::endl;
+        glDrawElementsIndirect(model_object.draw_mode, GL_UNSIGNED_INT, (void*)offset);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void Model::release() {
+    if (model_object.mesh >= 0) {
+        GeometryArena::get().release(model_object.mesh);
+        model_object.mesh = -1;
     }
 }
 
@@ -0,0 +1,102 @@
+#include "orbitRenderer.hpp"
+#include "glState.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+OrbitStats orbitStats;
+
+void OrbitRenderer::initialize() {
+    // the planets at their finest, grows on demand
+    vertices.create(GL_ARRAY_BUFFER, 16 * 1024 * sizeof(glm::fvec3));
+    glGenVertexArrays(1, &vao);
+    GLState::get().bindVertexArray(vao);
+    glEnableVertexAttribArray(0);
+    GLState::get().bindVertexArray(0);
+}
+
+void OrbitRenderer::draw(Shader &shader, const Frustum &frustum, float pixelScale, float maxError) {
+    const float pi = 3.14159265358979f;
+    orbitStats = OrbitStats();
+    segments.clear();
+    firsts.clear();
+    counts.clear();
+
+    // visible paths are packed to the front
+    GLint total = 0;
+    size_t visible = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        const OrbitPath path = paths[i];
+        float a = glm::length(path.p);
+        float b = glm::length(path.q);
+        // the ellipse is centred e * a behind the focus and lies within a of it
+        glm::fvec3 centre = path.focus - path.eccentricity * path.p;
+        if (a <= 0.0f || !frustum.testSphere(centre, a)) {
+            orbitStats.culled++;
+            continue;
+        }
+
+        // closest the camera (at 0) can be to the curve: out of its plane, and
+        // in the plane outside the ring between the semi-axes
+        glm::fvec3 camera = -centre;
+        glm::fvec3 normal = glm::normalize(glm::cross(path.p, path.q));
+        float height = glm::dot(camera, normal);
+        float inPlane = glm::length(camera - height * normal);
+        float across = std::max(std::max(inPlane - a, b - inPlane), 0.0f);
+        float distance = std::sqrt(height * height + across * across);
+
+        // |d^2 position / dE^2| <= a, a chord over dE strays at most a dE^2 / 8
+        // from the curve; at distance a world unit is pixelScale / distance pixels
+        float steps = (float)maxSegments;
+        if (distance > 0.0f) {
+            float dE = std::sqrt(8.0f * maxError * distance / (pixelScale * a));
+            steps = std::min(2.0f * pi / dE, steps);
+        }
+        int n = std::max((int)std::ceil(steps), minSegments);
+
+        paths[visible++] = path;
+        segments.push_back(n);
+        firsts.push_back(total);
+        // the strip ends on its first vertex again
+        counts.push_back(n + 1);
+        total += n + 1;
+    }
+    orbitStats.drawn = (unsigned int)visible;
+    orbitStats.vertices = (unsigned int)total;
+    if (visible == 0) {
+        return;
+    }
+
+    GLintptr offset = 0;
+    glm::fvec3* out = (glm::fvec3*)vertices.map((GLsizeiptr)total * sizeof(glm::fvec3), offset);
+    if (!out) {
+        return;
+    }
+    for (size_t i = 0; i < visible; i++) {
+        const OrbitPath& path = paths[i];
+        int n = segments[i];
+        // cos / sin of E advanced by rotation, one sincos per orbit
+        float step = 2.0f * pi / n;
+        float cd = std::cos(step), sd = std::sin(step);
+        float c = 1.0f, s = 0.0f;
+        glm::fvec3 start = path.focus + (1.0f - path.eccentricity) * path.p;
+        *out++ = start;
+        for (int k = 1; k < n; k++) {
+            float next = c * cd - s * sd;
+            s = s * cd + c * sd;
+            c = next;
+            *out++ = path.focus + (c - path.eccentricity) * path.p + s * path.q;
+        }
+        *out++ = start;
+    }
+    vertices.unmap();
+
+    shader.use();
+    GLState::get().bindVertexArray(vao);
+    // the stream moves every frame, the pointer follows it
+    glBindBuffer(GL_ARRAY_BUFFER, vertices.getID());
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::fvec3), (void*)offset);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glMultiDrawArrays(GL_LINE_STRIP, firsts.data(), counts.data(), (GLsizei)visible);
+    orbitStats.draws = 1;
+}
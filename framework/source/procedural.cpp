@@ -0,0 +1,197 @@
+#include "procedural.hpp"
+#include "cubeSphere.hpp"
+#include "jobs.hpp"
+#include "simd.hpp"
+#include "utils.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+unsigned int proceduralSeed(const std::string& name) {
+    unsigned int hash = 2166136261u;
+    for (char c : name) {
+        hash ^= (unsigned char)c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// hash without sine (Dave Hoskins), maps a 3d point to [0, 1)
+static float4 hash13(float4 x, float4 y, float4 z) {
+    float4 px = fract4(x * splat(0.1031f));
+    float4 py = fract4(y * splat(0.1031f));
+    float4 pz = fract4(z * splat(0.1031f));
+    float4 d = px * (pz + splat(31.32f)) + py * (py + splat(31.32f)) + pz * (px + splat(31.32f));
+    px = px + d;
+    py = py + d;
+    pz = pz + d;
+    return fract4((px + py) * pz);
+}
+
+static float4 smooth4(float4 f) {
+    return f * f * (splat(3.0f) - splat(2.0f) * f);
+}
+
+// trilinear value noise in [0, 1]
+static float4 valueNoise(float4 x, float4 y, float4 z) {
+    float4 ix = floor4(x), iy = floor4(y), iz = floor4(z);
+    float4 ux = smooth4(x - ix), uy = smooth4(y - iy), uz = smooth4(z - iz);
+    float4 one = splat(1.0f);
+
+    float4 c000 = hash13(ix,       iy,       iz);
+    float4 c100 = hash13(ix + one, iy,       iz);
+    float4 c010 = hash13(ix,       iy + one, iz);
+    float4 c110 = hash13(ix + one, iy + one, iz);
+    float4 c001 = hash13(ix,       iy,       iz + one);
+    float4 c101 = hash13(ix + one, iy,       iz + one);
+    float4 c011 = hash13(ix,       iy + one, iz + one);
+    float4 c111 = hash13(ix + one, iy + one, iz + one);
+
+    float4 x00 = mix4(c000, c100, ux), x10 = mix4(c010, c110, ux);
+    float4 x01 = mix4(c001, c101, ux), x11 = mix4(c011, c111, ux);
+    return mix4(mix4(x00, x10, uy), mix4(x01, x11, uy), uz);
+}
+
+// fractal brownian motion in roughly [-1, 1]
+static float4 fbm(float4 x, float4 y, float4 z, int octaves) {
+    float4 sum = splat(0.0f);
+    float amplitude = 0.5f;
+    for (int i = 0; i < octaves; i++) {
+        sum = sum + splat(amplitude) * (valueNoise(x, y, z) * splat(2.0f) - splat(1.0f));
+        x = x * splat(2.0f) + splat(19.19f);
+        y = y * splat(2.0f) + splat(7.31f);
+        z = z * splat(2.0f) + splat(3.77f);
+        amplitude *= 0.5f;
+    }
+    return sum;
+}
+
+// cellular (Worley) noise, distance to the closest feature point
+static float4 cellular(float4 x, float4 y, float4 z) {
+    float4 ix = floor4(x), iy = floor4(y), iz = floor4(z);
+    float4 best = splat(8.0f);
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                float4 cx = ix + splat((float)dx), cy = iy + splat((float)dy), cz = iz + splat((float)dz);
+                float4 fx = cx + hash13(cx, cy, cz) - x;
+                float4 fy = cy + hash13(cx + splat(17.1f), cy, cz) - y;
+                float4 fz = cz + hash13(cx, cy + splat(5.3f), cz) - z;
+                best = min4(best, fx * fx + fy * fy + fz * fz);
+            }
+        }
+    }
+    return sqrt4(best);
+}
+
+struct SurfaceStyle {
+    float offset[3];
+    float dark[3];
+    float light[3];
+    float frequency;
+    float craters;
+};
+
+static float seedValue(unsigned int seed, unsigned int index) {
+    unsigned int h = seed ^ (index * 0x9E3779B9u);
+    h ^= h >> 16; h *= 0x7FEB352Du;
+    h ^= h >> 15; h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return (h & 0xFFFFFF) / float(0x1000000);
+}
+
+static SurfaceStyle makeStyle(unsigned int seed) {
+    SurfaceStyle style;
+    for (unsigned int i = 0; i < 3; i++) {
+        // integer offsets keep the lattice aligned while decorrelating bodies
+        style.offset[i] = floorf(seedValue(seed, i) * 4096.0f);
+        float tint = seedValue(seed, 3 + i);
+        style.dark[i] = 0.12f + 0.25f * tint;
+        style.light[i] = 0.55f + 0.4f * tint;
+    }
+    style.frequency = 1.5f + 2.5f * seedValue(seed, 6);
+    style.craters = seedValue(seed, 7);
+    return style;
+}
+
+std::vector<unsigned char> generateSurface(unsigned int seed, int faceSize) {
+    std::vector<unsigned char> faces((size_t)6 * faceSize * faceSize * 3);
+    SurfaceStyle style = makeStyle(seed);
+
+    Jobs::get().parallelFor(6 * faceSize, [&](int begin, int end) {
+        float px[4], py[4], pz[4];
+        float height[4], crater[4];
+        for (int row = begin; row < end; row++) {
+            int face = row / faceSize;
+            int y = row % faceSize;
+            unsigned char* dst = faces.data() + (size_t)row * faceSize * 3;
+
+            for (int x = 0; x < faceSize; x += 4) {
+                int lanes = faceSize - x < 4 ? faceSize - x : 4;
+                for (int i = 0; i < 4; i++) {
+                    glm::vec3 dir = cubeFaceDirection(face, i < lanes ? x + i : x, y, faceSize);
+                    px[i] = dir.x;
+                    py[i] = dir.y;
+                    pz[i] = dir.z;
+                }
+                float4 dx = load4(px), dy = load4(py), dz = load4(pz);
+
+                float4 f = splat(style.frequency);
+                float4 h = fbm(dx * f + splat(style.offset[0]), dy * f + splat(style.offset[1]),
+                               dz * f + splat(style.offset[2]), 6);
+                float4 c = cellular(dx * f * splat(2.0f) + splat(style.offset[1]),
+                                    dy * f * splat(2.0f) + splat(style.offset[2]),
+                                    dz * f * splat(2.0f) + splat(style.offset[0]));
+                // bright rims around dark crater floors
+                float4 rim = clamp4(c * splat(2.5f), 0.0f, 1.0f);
+                float4 shade = mix4(splat(1.0f), splat(0.55f) + splat(0.45f) * rim, splat(style.craters));
+
+                store4(height, clamp4(h * splat(0.5f) + splat(0.5f), 0.0f, 1.0f));
+                store4(crater, shade);
+
+                for (int i = 0; i < lanes; i++) {
+                    for (int ch = 0; ch < 3; ch++) {
+                        float value = (style.dark[ch] + (style.light[ch] - style.dark[ch]) * height[i]) * crater[i];
+                        dst[(x + i) * 3 + ch] = (unsigned char)(value * 255.0f + 0.5f);
+                    }
+                }
+            }
+        }
+    });
+    return faces;
+}
+
+std::vector<unsigned char> proceduralSurface(unsigned int seed, int faceSize) {
+    std::string dir = resource_path + "cache/procedural/";
+    std::string path = dir + "surface_" + std::to_string(seed) + "_" + std::to_string(faceSize) + ".bin";
+    size_t bytes = (size_t)6 * faceSize * faceSize * 3;
+
+    std::ifstream in(path, std::ios::binary);
+    if (in.is_open()) {
+        unsigned int header[3] = { 0, 0, 0 };
+        in.read((char*)header, sizeof(header));
+        if (header[0] == proceduralVersion && header[1] == seed && header[2] == (unsigned int)faceSize) {
+            std::vector<unsigned char> faces(bytes);
+            in.read((char*)faces.data(), bytes);
+            if (in.gcount() == (std::streamsize)bytes) {
+                return faces;
+            }
+        }
+        in.close();
+    }
+
+    std::vector<unsigned char> faces = generateSurface(seed, faceSize);
+
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    std::ofstream out(path, std::ios::binary);
+    if (out.is_open()) {
+        unsigned int header[3] = { proceduralVersion, seed, (unsigned int)faceSize };
+        out.write((const char*)header, sizeof(header));
+        out.write((const char*)faces.data(), bytes);
+    } else {
+        std::cerr << "ERROR::PROCEDURAL::CANT WRITE CACHE::" << path << std::endl;
+    }
+    return faces;
+}
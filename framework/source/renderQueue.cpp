@@ -0,0 +1,145 @@
+#include "renderQueue.hpp"
+#include "glState.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+RenderQueueStats renderQueueStats;
+
+// one bound range always covers the whole block, even for a batch of one
+static const GLsizeiptr blockSize = maxInstances * sizeof(glm::fmat4);
+
+void RenderQueue::initialize(float aNearPlane) {
+    nearPlane = aNearPlane;
+
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    matrixAlignment = std::max(1u, (unsigned int)alignment / (unsigned int)sizeof(glm::fmat4));
+
+    matrixStream.create(GL_UNIFORM_BUFFER, blockSize * 4);
+}
+
+void RenderQueue::clear(const glm::fvec3 &viewPos) {
+    packets.clear();
+    viewPosition = viewPos;
+}
+
+void RenderQueue::push(RenderPass pass, Shader &shader, const Material* material, const modelObject &mesh,
+                       const glm::fmat4 &model, Texture* const* textures, int textureCount) {
+    DrawPacket packet;
+    packet.shader = &shader;
+    packet.material = material;
+    packet.mesh = &mesh;
+    packet.model = model;
+    for (int i = 0; i < textureCount && i < 3; i++) {
+        packet.textures[i] = textures[i];
+    }
+
+    // front to back inside a state, the ids only order packets, merging compares the real state;
+    // logarithmic like the depth buffer, a far plane would give everything past it one key
+    float distance = std::max(glm::length(glm::fvec3(model[3]) - viewPosition), nearPlane);
+    float depth = std::min(std::log2(distance / nearPlane) / depthOctaves, 1.0f);
+    unsigned long long texture = packet.textures[0] ? packet.textures[0]->getID() : 0;
+    packet.key = (unsigned long long)(pass & 0xF) << 60
+               | (unsigned long long)(shader.getID() & 0xFFF) << 48
+               | (unsigned long long)((material ? material->getIndex() : 0) & 0xFF) << 40
+               | (texture & 0xFFFF) << 24
+               | (unsigned long long)(mesh.mesh & 0xFF) << 16
+               | (unsigned long long)(depth * 65535.0f);
+    packets.push_back(packet);
+}
+
+// least significant byte first, bytes that every key shares are skipped
+void RenderQueue::sort() {
+    unsigned int count = (unsigned int)packets.size();
+    order.resize(count);
+    scratch.resize(count);
+    for (unsigned int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    if (count < 2) {
+        return;
+    }
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        unsigned int offsets[256] = {};
+        for (unsigned int i = 0; i < count; i++) {
+            offsets[(packets[i].key >> shift) & 0xFF]++;
+        }
+        if (offsets[(packets[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+        unsigned int sum = 0;
+        for (unsigned int& offset : offsets) {
+            unsigned int n = offset;
+            offset = sum;
+            sum += n;
+        }
+        for (unsigned int i = 0; i < count; i++) {
+            unsigned int index = order[i];
+            scratch[offsets[(packets[index].key >> shift) & 0xFF]++] = index;
+        }
+        order.swap(scratch);
+    }
+}
+
+bool RenderQueue::compatible(const DrawPacket &a, const DrawPacket &b) {
+    return a.shader == b.shader && a.material == b.material && a.mesh == b.mesh &&
+           a.textures[0] == b.textures[0] && a.textures[1] == b.textures[1] && a.textures[2] == b.textures[2];
+}
+
+void RenderQueue::submit() {
+    sort();
+
+    // merge runs of equal state, every batch starts on an aligned matrix
+    batches.clear();
+    matrices.clear();
+    unsigned int count = (unsigned int)order.size();
+    for (unsigned int i = 0; i < count;) {
+        const DrawPacket& first = packets[order[i]];
+        unsigned int end = i + 1;
+        while (end < count && end - i < (unsigned int)maxInstances && compatible(first, packets[order[end]])) {
+            end++;
+        }
+
+        size_t start = (matrices.size() + matrixAlignment - 1) / matrixAlignment * matrixAlignment;
+        matrices.resize(start);
+        for (unsigned int j = i; j < end; j++) {
+            matrices.push_back(packets[order[j]].model);
+        }
+        batches.push_back(Batch{ i, end - i, (GLintptr)(start * sizeof(glm::fmat4)) });
+        i = end;
+    }
+
+    renderQueueStats.packets = count;
+    renderQueueStats.draws = (unsigned int)batches.size();
+    if (batches.empty()) {
+        return;
+    }
+
+    // one write into this frame's stream region, the last range still needs a full block behind it
+    GLsizeiptr needed = (GLsizeiptr)(batches.back().offset + blockSize);
+    GLintptr base = 0;
+    void* data = matrixStream.map(needed, base);
+    if (!data) {
+        return;
+    }
+    std::memcpy(data, matrices.data(), matrices.size() * sizeof(glm::fmat4));
+    matrixStream.unmap();
+
+    for (const Batch& batch : batches) {
+        const DrawPacket& packet = packets[order[batch.first]];
+        packet.shader->use();
+        if (packet.material) {
+            packet.material->bind();
+        }
+        for (unsigned int unit = 0; unit < 3; unit++) {
+            if (packet.textures[unit]) {
+                packet.textures[unit]->bind(unit);
+            }
+        }
+        GLState::get().bindBufferRange(instanceBinding, matrixStream.getID(), base + batch.offset, blockSize);
+        drawMesh(*packet.mesh, batch.count);
+    }
+}
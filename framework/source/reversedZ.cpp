@@ -0,0 +1,48 @@
+#include "reversedZ.hpp"
+#include "shader.hpp"
+#include "glState.hpp"
+
+#include <cmath>
+
+static DepthMode depthMode = DEPTH_CLIP_CONTROL;
+
+DepthMode initializeDepth() {
+    if (GLEW_VERSION_4_5 || GLEW_ARB_clip_control) {
+        // keeps z / w as it is instead of remapping [-1, 1], which would spend
+        // the float precision around 0.5
+        glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+        depthMode = DEPTH_CLIP_CONTROL;
+    } else {
+        // gl_FragDepth turns off early z, only paid for where clip control is missing
+        Shader::define("LOG_DEPTH");
+        depthMode = DEPTH_LOGARITHMIC;
+    }
+    glClearDepth(0.0);
+    GLState::get().depthFunc(GL_GREATER);
+    return depthMode;
+}
+
+DepthMode getDepthMode() {
+    return depthMode;
+}
+
+const char* getDepthModeName() {
+    return depthMode == DEPTH_CLIP_CONTROL ? "reversed-z, clip control" : "reversed-z, logarithmic";
+}
+
+glm::mat4 reversedPerspective(float fovy, float aspect, float nearPlane) {
+    float f = 1.0f / std::tan(fovy * 0.5f);
+    glm::mat4 projection(0.0f);
+    projection[0][0] = f / aspect;
+    projection[1][1] = f;
+    projection[2][3] = -1.0f;
+    projection[3][2] = nearPlane;
+    return projection;
+}
+
+float reversedDepth(float distance, float nearPlane) {
+    if (depthMode == DEPTH_LOGARITHMIC) {
+        return 1.0f - std::log2(1.0f + distance) / std::log2(1.0f + logDepthFar);
+    }
+    return nearPlane / distance;
+}
@@ -1,138 +1,555 @@
 #include "shader.hpp"
 #include "utils.hpp"
+#include "glState.hpp"
+#ifndef SHADERS_FROM_DISK
+#include "embeddedShaders.hpp"
+#endif
 
 #include <sstream>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <filesystem>
+#include <chrono>
+
+ShaderStats shaderStats;
+ShaderStats lastShaderStats;
+ShaderCacheStats shaderCacheStats;
+
+static std::unordered_map<std::string, GLuint> blockBindings;
+static std::string globalDefines;
 
 Shader::Shader() {}
 
-Shader::Shader(std::string str) {
-    vertexSource = str + ".vert";
-    fragmentSource = str + ".frag";
+Shader::Shader(std::string str, std::vector<std::string> aFeatures) {
+    setSource(str);
+    features = aFeatures;
 }
 
 void Shader::setSource(std::string str) {
     vertexSource = str + ".vert";
     fragmentSource = str + ".frag";
+    geometrySource = str + ".geom";
+    computeSource = str + ".comp";
+}
+
+// sources are compiled in by cmake/embedShaders.cmake unless SHADERS_FROM_DISK is set
+static bool readShaderSource(const std::string& filepath, std::string& source) {
+#ifdef SHADERS_FROM_DISK
+	std::ifstream file(resource_path + "shaders/" + filepath);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    source = ss.str();
+    return true;
+#else
+    for (const EmbeddedShader& shader : embeddedShaders) {
+        if (filepath == shader.name) {
+            source = shader.source;
+            return true;
+        }
+    }
+    return false;
+#endif
 }
 
-std::string ParseShader(const std::string& filepath) {
-	std::ifstream stream(resource_path + "shaders/" + filepath);
+static bool hasShaderSource(const std::string& filepath) {
+    std::string source;
+    return readShaderSource(filepath, source);
+}
+
+// reads a stage and pastes every #include "file" in place, shared code lives in shaders/include
+std::string ParseShader(const std::string& filepath, int depth) {
+    std::string source;
+    if (!readShaderSource(filepath, source)) {
+        std::cerr << "ERROR::SHADER::CANT OPEN FILE::" << filepath << std::endl;
+        return "";
+    }
+	std::istringstream stream(source);
 	std::string line;
 	std::stringstream ss[1];
 	
 	while (getline(stream, line)) {
+        size_t directive = line.find("#include");
+        if (directive != std::string::npos && line.find_first_not_of(" \t") == directive) {
+            size_t open = line.find('"', directive);
+            size_t close = line.find('"', open + 1);
+            if (open == std::string::npos || close == std::string::npos || depth > 8) {
+                std::cerr << "ERROR::SHADER::BAD INCLUDE IN " << filepath << "::" << line << std::endl;
+                continue;
+            }
+            ss[0] << ParseShader("include/" + line.substr(open + 1, close - open - 1), depth + 1);
+            continue;
+        }
 		ss[0] << line << '\n';
 	}
     //std::cout << ss[0].str() << std::endl;
 	return ss[0].str();
 }
 
+// variant defines have to follow the #version line
+static std::string injectDefines(const std::string& source, const std::string& defines) {
+    size_t version = source.find("#version");
+    if (version == std::string::npos) {
+        return defines + source;
+    }
+    size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos) {
+        return source + "\n" + defines;
+    }
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
 unsigned int Shader::compileShader(unsigned int type, const std::string& source) {
 	unsigned int id = glCreateShader(type);
 	const char* src = source.c_str();
 	glShaderSource(id, 1, &src, nullptr);
 	glCompileShader(id);
+    // the status is only read if linking fails, querying here would wait for the driver
+	return id;
+}
 
+static void printCompileLog(unsigned int id, const std::string& name) {
 	GLint success;
     char infoLog[512];
     glGetShaderiv(id, GL_COMPILE_STATUS, &success);
     if (!success) {
         glGetShaderInfoLog(id, 512, NULL, infoLog);
-        std::cout << "Failed to compile shader\n" << infoLog << std::endl;
+        std::cout << "Failed to compile shader " << name << "\n" << infoLog << std::endl;
+    }
+}
+
+// FNV-1a, good enough to tell program sources and drivers apart
+static unsigned long long hashString(const std::string& str, unsigned long long hash = 14695981039346656037ull) {
+    for (char c : str) {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// binaries are only valid for the exact driver that produced them
+static const std::string &driverString() {
+    static std::string driver;
+    if (driver.empty()) {
+        const char* vendor = (const char*)glGetString(GL_VENDOR);
+        const char* renderer = (const char*)glGetString(GL_RENDERER);
+        const char* version = (const char*)glGetString(GL_VERSION);
+        driver = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+    }
+    return driver;
+}
+
+std::string Shader::binaryCachePath(const std::vector<std::string>& sources) {
+    unsigned long long hash = 14695981039346656037ull;
+    for (unsigned int i = 0; i < sources.size(); i++) {
+        hash = hashString(i == 0 ? sources[i] : std::string(1, '\0') + sources[i], hash);
+    }
+    for (const std::string& varying : feedbackVaryings) {
+        hash = hashString(std::string(1, '\0') + varying, hash);
+    }
+    hash = hashString(std::string(1, '\0') + driverString(), hash);
+
+    std::stringstream ss;
+    ss << resource_path << "cache/shaders/" << vertexSource.substr(0, vertexSource.find('.')) << "_" << std::hex << hash << ".bin";
+    return ss.str();
+}
+
+bool Shader::loadBinary(ShaderProgram& program, const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    GLenum format = 0;
+    in.read((char*)&format, sizeof(format));
+    std::vector<char> binary((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (binary.empty()) {
+        return false;
+    }
+
+    // drivers reject binaries after updates, completeVariant then compiles from source
+    glProgramBinary(program.ID, format, binary.data(), (GLsizei)binary.size());
+    return true;
+}
+
+void Shader::saveBinary(ShaderProgram& program, const std::string& path) {
+    GLint length = 0;
+    glGetProgramiv(program.ID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program.ID, length, nullptr, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    std::ofstream out(path, std::ios::binary);
+    if (out.is_open()) {
+        out.write((const char*)&format, sizeof(format));
+        out.write(binary.data(), binary.size());
+    } else {
+        std::cerr << "ERROR::SHADER::CANT WRITE BINARY CACHE::" << path << std::endl;
     }
-	return id;
 }
 
- 
 void Shader::createShader() {
-    ID = glCreateProgram();
-	unsigned int vs = compileShader(GL_VERTEX_SHADER, ParseShader(vertexSource));
-	unsigned int fs = compileShader(GL_FRAGMENT_SHADER, ParseShader(fragmentSource));
-    
-	glAttachShader(ID, vs);
-	glAttachShader(ID, fs);
-	glLinkProgram(ID);
-	glValidateProgram(ID);
-    
+    // optional stages are picked up when their file exists
+    if (hasShaderSource(computeSource)) {
+        computeCode = ParseShader(computeSource);
+    } else {
+        vertexCode = ParseShader(vertexSource);
+        geometryCode = hasShaderSource(geometrySource) ? ParseShader(geometrySource) : "";
+        fragmentCode = hasShaderSource(fragmentSource) || feedbackVaryings.empty() ? ParseShader(fragmentSource) : "";
+    }
+    loaded = true;
+    setVariant(variant);
+}
+
+void Shader::setVariant(unsigned int mask) {
+    variant = mask;
+    if (!loaded) {
+        // remembered until createShader, so startup builds the variant that is actually used
+        return;
+    }
+    auto it = variants.find(mask);
+    if (it == variants.end()) {
+        it = variants.emplace(mask, ShaderProgram()).first;
+        submitVariant(it->second, mask);
+    }
+    current = &it->second;
+}
+
+void Shader::setVariant(std::initializer_list<bool> flags) {
+    unsigned int mask = 0, bit = 0;
+    for (bool flag : flags) {
+        mask |= (flag ? 1u : 0u) << bit++;
+    }
+    setVariant(mask);
+}
+
+std::string Shader::variantDefines(unsigned int mask) const {
+    std::string defines = globalDefines;
+    for (unsigned int i = 0; i < features.size(); i++) {
+        if (mask & (1u << i)) {
+            defines += "#define " + features[i] + "\n";
+        }
+    }
+    return defines;
+}
+
+// hands the work to the driver without reading anything back, so with
+// KHR_parallel_shader_compile all programs build while the cpu loads assets
+void Shader::submitVariant(ShaderProgram& program, unsigned int mask, bool allowBinary) {
+    std::string defines = variantDefines(mask);
+    // stage order is fixed so the cache hash of vertex / fragment programs stays the same
+    const std::pair<GLenum, const std::string*> stageCode[] = {
+        { GL_VERTEX_SHADER, &vertexCode },
+        { GL_FRAGMENT_SHADER, &fragmentCode },
+        { GL_GEOMETRY_SHADER, &geometryCode },
+        { GL_COMPUTE_SHADER, &computeCode },
+    };
+    std::vector<std::pair<GLenum, std::string>> stages;
+    std::vector<std::string> sources;
+    for (const auto& stage : stageCode) {
+        if (!stage.second->empty()) {
+            stages.emplace_back(stage.first, injectDefines(*stage.second, defines));
+            sources.push_back(stages.back().second);
+        }
+    }
+
+    program.ID = glCreateProgram();
+    program.mask = mask;
+    program.pending = true;
+
+    bool binaries = GLEW_ARB_get_program_binary != 0;
+    program.cachePath = binaries ? binaryCachePath(sources) : "";
+    if (binaries && allowBinary && loadBinary(program, program.cachePath)) {
+        shaderCacheStats.loaded++;
+        program.fromBinary = true;
+        return;
+    }
+    shaderCacheStats.compiled++;
+    program.fromBinary = false;
+
+    program.stages.clear();
+    for (const auto& stage : stages) {
+        program.stages.push_back(compileShader(stage.first, stage.second));
+        glAttachShader(program.ID, program.stages.back());
+    }
+    if (!feedbackVaryings.empty()) {
+        std::vector<const char*> names;
+        for (const std::string& varying : feedbackVaryings) {
+            names.push_back(varying.c_str());
+        }
+        glTransformFeedbackVaryings(program.ID, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+    }
+    if (binaries) {
+        glProgramParameteri(program.ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+	glLinkProgram(program.ID);
+}
+
+// first point that reads the link status, blocks until the driver is done
+void Shader::completeVariant(ShaderProgram& program) {
+    auto start = std::chrono::steady_clock::now();
+
 	int success;
     char infoLog[512];
-	glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(ID, 512, NULL, infoLog);
-        std::cout << "Failed to link shader program\n" << infoLog << std::endl;
+	glGetProgramiv(program.ID, GL_LINK_STATUS, &success);
+
+    if (program.fromBinary && !success) {
+        // stale binary, start over from source and wait for that instead; the
+        // file goes now, a successful link below writes a fresh one
+        shaderCacheStats.loaded--;
+        std::error_code error;
+        std::filesystem::remove(program.cachePath, error);
+        glDeleteProgram(program.ID);
+        unsigned int mask = program.mask;
+        submitVariant(program, mask, false);
+        glGetProgramiv(program.ID, GL_LINK_STATUS, &success);
+    }
+
+    if (!program.fromBinary) {
+        if (!success) {
+            for (unsigned int stage : program.stages) {
+                printCompileLog(stage, vertexSource.substr(0, vertexSource.find('.')));
+            }
+            glGetProgramInfoLog(program.ID, 512, NULL, infoLog);
+            std::cout << "Failed to link shader program " << vertexSource << "\n" << variantDefines(program.mask) << infoLog << std::endl;
+        } else if (!program.cachePath.empty()) {
+            saveBinary(program, program.cachePath);
+        }
+
+        for (unsigned int stage : program.stages) {
+            glDetachShader(program.ID, stage);
+            glDeleteShader(stage);
+        }
+        program.stages.clear();
+    }
+    program.pending = false;
+
+    reflectUniforms(program);
+    bindUniformBlocks(program);
+
+    shaderCacheStats.waitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool Shader::isReady() const {
+    if (!current || !current->pending) {
+        return current != nullptr;
+    }
+    if (!GLEW_KHR_parallel_shader_compile) {
+        return false;
+    }
+    GLint done = GL_FALSE;
+    glGetProgramiv(current->ID, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+void Shader::complete() {
+    if (current && current->pending) {
+        completeVariant(*current);
+    }
+}
+
+void Shader::registerBlock(const std::string &name, GLuint binding) {
+    blockBindings[name] = binding;
+}
+
+void Shader::define(const std::string &name) {
+    globalDefines += "#define " + name + "\n";
+}
+
+// GLSL 330 has no binding layout qualifier, so blocks are bound after linking
+void Shader::bindUniformBlocks(ShaderProgram& program) {
+    for (const auto& block : blockBindings) {
+        GLuint index = glGetUniformBlockIndex(program.ID, block.first.c_str());
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(program.ID, index, block.second);
+        }
+    }
+}
+
+// builds the name -> location table once, so no name is resolved on the hot path
+void Shader::reflectUniforms(ShaderProgram& program) {
+    program.uniforms.clear();
+
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(program.ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program.ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::string name(maxLength > 0 ? maxLength : 1, '\0');
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = GL_NONE;
+        glGetActiveUniform(program.ID, (GLuint)i, maxLength, &length, &size, &type, &name[0]);
+        std::string uniformName = name.substr(0, length);
+
+        shaderStats.locationQueries++;
+        GLint location = glGetUniformLocation(program.ID, uniformName.c_str());
+        if (location < 0) {
+            // members of uniform blocks have no location
+            continue;
+        }
+        program.uniforms[uniformName] = location;
+        // arrays are reported as "name[0]", make them reachable as "name" too
+        size_t bracket = uniformName.find('[');
+        if (bracket != std::string::npos) {
+            program.uniforms[uniformName.substr(0, bracket)] = location;
+        }
+    }
+
+    program.modelLocation = findLocation(program, "model");
+
+    // handles handed out before this variant existed
+    program.slots.clear();
+    for (const std::string& slotName : slotNames) {
+        program.slots.push_back(findLocation(program, slotName));
+    }
+}
+
+GLint Shader::findLocation(const ShaderProgram& program, const std::string &name) {
+    auto it = program.uniforms.find(name);
+    return it != program.uniforms.end() ? it->second : -1;
+}
+
+GLint Shader::getLocation(const std::string &name) const {
+    return current ? findLocation(*current, name) : -1;
+}
+
+// handles name a slot, every variant resolves the slot to its own location
+int Shader::getSlot(const std::string &name) {
+    for (unsigned int i = 0; i < slotNames.size(); i++) {
+        if (slotNames[i] == name) {
+            return (int)i;
+        }
     }
+    slotNames.push_back(name);
+    // pending programs fill all their slots once they are reflected
+    for (auto& it : variants) {
+        if (!it.second.pending) {
+            it.second.slots.push_back(findLocation(it.second, name));
+        }
+    }
+    return (int)slotNames.size() - 1;
+}
 
-	glDeleteShader(vs);
-	glDeleteShader(fs);
+GLint Shader::slotLocation(int slot) const {
+    return current && slot >= 0 && slot < (int)current->slots.size() ? current->slots[slot] : -1;
 }
 
-unsigned int &Shader::getID() {
-    return ID;
+// the by-name setters below go through the table instead of the driver
+GLint Shader::nameLocation(const std::string &name) const {
+    shaderStats.nameLookups++;
+    shaderStats.uploads++;
+    return getLocation(name);
+}
+
+unsigned int Shader::getID() const {
+    return current ? current->ID : 0;
 }
 
 void Shader::use() { 
-    glUseProgram(ID); 
+    complete();
+    GLState::get().useProgram(getID()); 
+}
+
+void Shader::set(Uniform<bool> uniform, bool value) const {
+    shaderStats.uploads++;
+    glUniform1i(slotLocation(uniform.slot), (int)value);
+}
+
+void Shader::set(Uniform<int> uniform, int value) const {
+    shaderStats.uploads++;
+    glUniform1i(slotLocation(uniform.slot), value);
+}
+
+void Shader::set(Uniform<float> uniform, float value) const {
+    shaderStats.uploads++;
+    glUniform1f(slotLocation(uniform.slot), value);
+}
+
+void Shader::set(Uniform<glm::ivec2> uniform, const glm::ivec2 &value) const {
+    shaderStats.uploads++;
+    glUniform2iv(slotLocation(uniform.slot), 1, &value[0]);
+}
+
+void Shader::set(Uniform<glm::fvec2> uniform, const glm::fvec2 &value) const {
+    shaderStats.uploads++;
+    glUniform2fv(slotLocation(uniform.slot), 1, &value[0]);
+}
+
+void Shader::set(Uniform<glm::fvec3> uniform, const glm::fvec3 &value) const {
+    shaderStats.uploads++;
+    glUniform3fv(slotLocation(uniform.slot), 1, &value[0]);
+}
+
+void Shader::set(Uniform<glm::fvec4> uniform, const glm::fvec4 *values, int count) const {
+    shaderStats.uploads++;
+    glUniform4fv(slotLocation(uniform.slot), count, &values[0][0]);
+}
+
+void Shader::set(Uniform<glm::fmat4> uniform, const glm::fmat4 &mat) const {
+    shaderStats.uploads++;
+    glUniformMatrix4fv(slotLocation(uniform.slot), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setBool(const std::string &name, bool value) const {         
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    glUniform1i(nameLocation(name), (int)value); 
 }
 
 void Shader::setInt(const std::string &name, int value) const { 
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    glUniform1i(nameLocation(name), value); 
 }
 
 void Shader::setFloat(const std::string &name, float value) const { 
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    glUniform1f(nameLocation(name), value); 
 }
 
 void Shader::setfVec2(const std::string &name, const glm::fvec2 &value) const { 
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    glUniform2fv(nameLocation(name), 1, &value[0]); 
 }
 void Shader::setfVec2(const std::string &name, float x, float y) const { 
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+    glUniform2f(nameLocation(name), x, y); 
 }
 
 void Shader::setfVec3(const std::string &name, const glm::fvec3 &value) const { 
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    glUniform3fv(nameLocation(name), 1, &value[0]); 
 }
 void Shader::setfVec3(const std::string &name, float x, float y, float z) const { 
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+    glUniform3f(nameLocation(name), x, y, z); 
 }
 
 void Shader::setfVec4(const std::string &name, const glm::fvec4 &value) const { 
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    glUniform4fv(nameLocation(name), 1, &value[0]); 
 }
 void Shader::setfVec4(const std::string &name, float x, float y, float z, float w) { 
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+    glUniform4f(nameLocation(name), x, y, z, w); 
 }
 
 void Shader::setfMat2(const std::string &name, const glm::fmat2 &mat) const {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(nameLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setfMat3(const std::string &name, const glm::fmat3 &mat) const {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(nameLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setfMat4(const std::string &name, const glm::fmat4 &mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-}
-
-void Shader::setView(const glm::fmat4 &mat) const {
-    glUseProgram(ID);
-    glUniformMatrix4fv(glGetUniformLocation(ID, "view"), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(nameLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::setProjection(const glm::fmat4 &mat) const {
-    glUseProgram(ID);
-    glUniformMatrix4fv(glGetUniformLocation(ID, "projection"), 1, GL_FALSE, &mat[0][0]);
-}
-
-void Shader::setModel(const glm::fmat4 &mat) const {
-    glUseProgram(ID);
-    glUniformMatrix4fv(glGetUniformLocation(ID, "model"), 1, GL_FALSE, &mat[0][0]);
+void Shader::setModel(const glm::fmat4 &mat) {
+    // completes a pending variant, its location is not known before
+    use();
+    if (!current) {
+        return;
+    }
+    shaderStats.uploads++;
+    glUniformMatrix4fv(current->modelLocation, 1, GL_FALSE, &mat[0][0]);
 }
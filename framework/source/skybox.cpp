@@ -1,5 +1,6 @@
 #include "skybox.hpp"
 #include "utils.hpp"
+#include "glState.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.hpp"
 
@@ -52,6 +53,5 @@ void Skybox::setTexture() {
 }  
 
 void Skybox::bind() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, ID);
+    GLState::get().bindTexture(0, GL_TEXTURE_CUBE_MAP, ID);
 }
@@ -0,0 +1,281 @@
+#include "starCatalogue.hpp"
+#include "glState.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <random>
+#include <utility>
+
+StarStats starStats;
+
+static const double pi = 3.14159265358979323846;
+
+struct StarCacheHeader {
+    unsigned int version;
+    unsigned int count;
+    // size of the csv it was imported from, 0 when it is not checked
+    unsigned long long sourceSize;
+};
+
+static bool byMagnitude(const PackedStar &a, const PackedStar &b) {
+    return a.magnitude < b.magnitude;
+}
+
+// one csv line, quoted fields may hold commas; spaces are dropped, no field read needs them
+static void splitCsv(const std::string &line, std::vector<std::string> &fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (c == ',' && !quoted) {
+            fields.push_back(field);
+            field.clear();
+        } else if (c != '\r' && c != ' ') {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+}
+
+struct CsvColumn {
+    int index = -1;
+    // to radians for angles, 1 otherwise
+    double scale = 1.0;
+};
+
+// the first of names the header has; HYG and the Hipparcos exports name and
+// scale right ascension and declination differently
+static CsvColumn findColumn(const std::vector<std::string> &header,
+                            std::initializer_list<std::pair<const char*, double>> names) {
+    CsvColumn column;
+    for (const auto& name : names) {
+        for (size_t i = 0; i < header.size(); i++) {
+            if (header[i] == name.first) {
+                column.index = (int)i;
+                column.scale = name.second;
+                return column;
+            }
+        }
+    }
+    return column;
+}
+
+static bool readField(const std::vector<std::string> &fields, const CsvColumn &column, double &value) {
+    if (column.index < 0 || column.index >= (int)fields.size() || fields[column.index].empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtod(fields[column.index].c_str(), &end) * column.scale;
+    return end != fields[column.index].c_str();
+}
+
+glm::vec3 StarCatalogue::equatorialToScene(double ra, double dec) {
+    const double obliquity = 23.4393 * pi / 180.0;
+    glm::dvec3 equatorial(std::cos(dec) * std::cos(ra), std::cos(dec) * std::sin(ra), std::sin(dec));
+    glm::dvec3 ecliptic(equatorial.x,
+                        equatorial.y * std::cos(obliquity) + equatorial.z * std::sin(obliquity),
+                        -equatorial.y * std::sin(obliquity) + equatorial.z * std::cos(obliquity));
+    return glm::vec3(ecliptic.y, ecliptic.z, ecliptic.x);
+}
+
+PackedStar StarCatalogue::pack(const glm::vec3 &direction, float magnitude, float colour) {
+    // octahedral: onto |x| + |y| + |z| = 1, the lower half folded over the upper
+    glm::vec3 n = direction / (std::fabs(direction.x) + std::fabs(direction.y) + std::fabs(direction.z));
+    glm::vec2 e(n.x, n.y);
+    if (n.z < 0.0f) {
+        e = glm::vec2((1.0f - std::fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                      (1.0f - std::fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    float m = (magnitude - starMagnitudeMin) / (starMagnitudeMax - starMagnitudeMin);
+    float c = (colour - starColourMin) / (starColourMax - starColourMin);
+
+    PackedStar star;
+    star.direction[0] = (GLshort)std::lround(glm::clamp(e.x, -1.0f, 1.0f) * 32767.0f);
+    star.direction[1] = (GLshort)std::lround(glm::clamp(e.y, -1.0f, 1.0f) * 32767.0f);
+    star.magnitude = (GLushort)std::lround(glm::clamp(m, 0.0f, 1.0f) * 65535.0f);
+    star.colour = (GLushort)std::lround(glm::clamp(c, 0.0f, 1.0f) * 65535.0f);
+    return star;
+}
+
+bool StarCatalogue::importCsv(const std::string &path, std::vector<PackedStar> &stars) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "ERROR::STARCATALOGUE::CANT OPEN::" << path << std::endl;
+        return false;
+    }
+    std::string line;
+    std::vector<std::string> fields;
+    if (!std::getline(in, line)) {
+        return false;
+    }
+    splitCsv(line, fields);
+    CsvColumn ra = findColumn(fields, { { "rarad", 1.0 }, { "ra", pi / 12.0 }, { "RAdeg", pi / 180.0 },
+                                        { "RAICRS", pi / 180.0 }, { "_RAJ2000", pi / 180.0 } });
+    CsvColumn dec = findColumn(fields, { { "decrad", 1.0 }, { "dec", pi / 180.0 }, { "DEdeg", pi / 180.0 },
+                                         { "DEICRS", pi / 180.0 }, { "_DEJ2000", pi / 180.0 } });
+    CsvColumn mag = findColumn(fields, { { "mag", 1.0 }, { "Vmag", 1.0 }, { "Hpmag", 1.0 } });
+    CsvColumn ci = findColumn(fields, { { "ci", 1.0 }, { "B-V", 1.0 } });
+    if (ra.index < 0 || dec.index < 0 || mag.index < 0) {
+        std::cerr << "ERROR::STARCATALOGUE::MISSING COLUMNS::" << path << std::endl;
+        return false;
+    }
+
+    stars.clear();
+    while (std::getline(in, line)) {
+        splitCsv(line, fields);
+        double alpha, delta, magnitude;
+        if (!readField(fields, ra, alpha) || !readField(fields, dec, delta) || !readField(fields, mag, magnitude)) {
+            continue;
+        }
+        // the sun is in HYG too
+        if (magnitude < starMagnitudeMin || magnitude > starMagnitudeMax) {
+            continue;
+        }
+        // about the sun's, for stars without photometry
+        double colour = 0.65;
+        readField(fields, ci, colour);
+        stars.push_back(pack(equatorialToScene(alpha, delta), (float)magnitude, (float)colour));
+        // bounded however big the file is, the faintest half is dropped
+        if (stars.size() >= 2 * maxStars) {
+            std::nth_element(stars.begin(), stars.begin() + maxStars, stars.end(), byMagnitude);
+            stars.resize(maxStars);
+        }
+    }
+    std::stable_sort(stars.begin(), stars.end(), byMagnitude);
+    if (stars.size() > maxStars) {
+        stars.resize(maxStars);
+    }
+    return !stars.empty();
+}
+
+bool StarCatalogue::readCache(const std::string &path, unsigned long long sourceSize, std::vector<PackedStar> &stars) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    StarCacheHeader header = {};
+    in.read((char*)&header, sizeof(header));
+    if (in.gcount() != (std::streamsize)sizeof(header) || header.version != starCatalogueVersion ||
+        header.count > maxStars || (sourceSize != 0 && header.sourceSize != sourceSize)) {
+        return false;
+    }
+    stars.resize(header.count);
+    std::streamsize bytes = (std::streamsize)header.count * sizeof(PackedStar);
+    in.read((char*)stars.data(), bytes);
+    return in.gcount() == bytes;
+}
+
+void StarCatalogue::writeCache(const std::string &path, unsigned long long sourceSize, const std::vector<PackedStar> &stars) {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "ERROR::STARCATALOGUE::CANT WRITE CACHE::" << path << std::endl;
+        return;
+    }
+    StarCacheHeader header = { starCatalogueVersion, (unsigned int)stars.size(), sourceSize };
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)stars.data(), (std::streamsize)stars.size() * sizeof(PackedStar));
+}
+
+void StarCatalogue::synthesize(unsigned int amount, std::vector<PackedStar> &stars) {
+    std::mt19937 rng(4242);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> colours(0.65f, 0.45f);
+    // star counts grow about 10^0.45 per magnitude down to 9.5, as the real sky
+    // does, so the limiting magnitude slider behaves the same on either
+    const float k = 0.45f;
+    float low = std::pow(10.0f, k * -1.5f);
+    float high = std::pow(10.0f, k * 9.5f);
+
+    stars.resize(std::min(amount, maxStars));
+    for (PackedStar& star : stars) {
+        float z = unit(rng) * 2.0f - 1.0f;
+        float phi = 2.0f * (float)pi * unit(rng);
+        float r = std::sqrt(1.0f - z * z);
+        glm::vec3 direction(r * std::cos(phi), z, r * std::sin(phi));
+        float magnitude = std::log10(low + unit(rng) * (high - low)) / k;
+        star = pack(direction, magnitude, colours(rng));
+    }
+    std::stable_sort(stars.begin(), stars.end(), byMagnitude);
+}
+
+void StarCatalogue::upload(std::vector<PackedStar> &stars) {
+    count = (unsigned int)stars.size();
+    starStats.loaded = count;
+
+    // the buffer is sorted, so each entry is where the first fainter star sits
+    int steps = (int)std::ceil((starMagnitudeMax - starMagnitudeMin) / magnitudeStep) + 1;
+    brighter.assign(steps, 0);
+    size_t star = 0;
+    for (int k = 0; k < steps; k++) {
+        float limit = std::min(k * magnitudeStep / (starMagnitudeMax - starMagnitudeMin), 1.0f) * 65535.0f;
+        while (star < stars.size() && stars[star].magnitude < limit) {
+            star++;
+        }
+        brighter[k] = (GLsizei)star;
+    }
+    brighter.back() = (GLsizei)stars.size();
+
+    if (vao == 0) {
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &buffer);
+    }
+    GLState::get().bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)stars.size() * sizeof(PackedStar), stars.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_SHORT, GL_TRUE, sizeof(PackedStar), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedStar), (void*)(2 * sizeof(GLshort)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::get().bindVertexArray(0);
+}
+
+void StarCatalogue::load(const std::string &name, unsigned int fallbackCount) {
+    std::string csvPath = resource_path + "stars/" + name;
+    std::string cachePath = resource_path + "cache/stars/" + name + ".bin";
+    std::error_code error;
+    unsigned long long size = std::filesystem::file_size(csvPath, error);
+    bool haveCsv = !error;
+
+    std::vector<PackedStar> stars;
+    // the binary file alone is enough, the csv only decides whether it is stale
+    if (readCache(cachePath, haveCsv ? size : 0, stars)) {
+        starStats.source = "cache";
+    } else if (haveCsv && importCsv(csvPath, stars)) {
+        writeCache(cachePath, size, stars);
+        starStats.source = "catalogue";
+    } else {
+        synthesize(fallbackCount, stars);
+        starStats.source = "synthetic";
+    }
+    std::clog << "Stars: " << stars.size() << " from " << starStats.source << std::endl;
+    upload(stars);
+}
+
+GLsizei StarCatalogue::countBrighterThan(float limit) const {
+    if (brighter.empty()) {
+        return 0;
+    }
+    int k = (int)std::floor((limit - starMagnitudeMin) / magnitudeStep);
+    return brighter[std::min(std::max(k, 0), (int)brighter.size() - 1)];
+}
+
+void StarCatalogue::draw(float limit) {
+    GLsizei visible = countBrighterThan(limit);
+    starStats.drawn = (unsigned int)visible;
+    if (visible == 0) {
+        return;
+    }
+    GLState::get().bindVertexArray(vao);
+    glDrawArrays(GL_POINTS, 0, visible);
+}
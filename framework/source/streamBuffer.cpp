@@ -0,0 +1,131 @@
+#include "streamBuffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+StreamStats streamStats;
+StreamStats lastStreamStats;
+
+void FrameFences::beginFrame() {
+    GLsync& fence = fences[getRegion()];
+    if (fence == 0) {
+        return;
+    }
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        auto start = std::chrono::steady_clock::now();
+        GLenum status;
+        do {
+            // flushes once, so the fence is sure to be reached
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        if (status == GL_WAIT_FAILED) {
+            std::cerr << "ERROR::STREAMBUFFER::FENCE WAIT FAILED" << std::endl;
+        }
+        streamStats.stallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        streamStats.stalls++;
+    }
+    glDeleteSync(fence);
+    fence = 0;
+}
+
+void FrameFences::endFrame() {
+    fences[getRegion()] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame++;
+}
+
+bool StreamBuffer::isPersistent() {
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+void StreamBuffer::create(GLenum aTarget, GLsizeiptr frameSize) {
+    target = aTarget;
+    // bind ranges need the driver's alignment; 256 is the largest the spec
+    // allows for storage buffers, which the belt is bound as
+    GLint align = 256;
+    if (target == GL_UNIFORM_BUFFER) {
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    }
+    alignment = std::max(1, align);
+    if (buffer != 0) {
+        retire();
+    }
+    allocate(frameSize);
+}
+
+void StreamBuffer::allocate(GLsizeiptr aRegionSize) {
+    regionSize = (std::max<GLsizeiptr>(aRegionSize, 1) + alignment - 1) / alignment * alignment;
+    head = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    if (isPersistent()) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLsizeiptr size = regionSize * FrameFences::framesInFlight;
+        glBufferStorage(target, size, nullptr, flags);
+        mapped = (unsigned char*)glMapBufferRange(target, 0, size, flags);
+        if (!mapped) {
+            std::cerr << "ERROR::STREAMBUFFER::PERSISTENT MAP FAILED" << std::endl;
+        }
+    } else {
+        // one region, orphaned at the start of every frame
+        glBufferData(target, regionSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(target, 0);
+}
+
+void StreamBuffer::retire() {
+    retired.push_back(Retired{ buffer, FrameFences::get().getFrame() });
+    buffer = 0;
+    mapped = nullptr;
+}
+
+void* StreamBuffer::map(GLsizeiptr size, GLintptr &offset) {
+    FrameFences& frames = FrameFences::get();
+    if (frame != frames.getFrame()) {
+        frame = frames.getFrame();
+        head = 0;
+        // every frame that could still read them has passed its fence
+        while (!retired.empty() && retired.front().frame + FrameFences::framesInFlight <= frame) {
+            glDeleteBuffers(1, &retired.front().buffer);
+            retired.erase(retired.begin());
+        }
+        if (!mapped) {
+            glBindBuffer(target, buffer);
+            glBufferData(target, regionSize, nullptr, GL_STREAM_DRAW);
+            glBindBuffer(target, 0);
+        }
+    }
+
+    GLintptr start = (head + alignment - 1) / alignment * alignment;
+    if (start + size > regionSize) {
+        // ranges handed out earlier this frame stay readable in the old storage
+        retire();
+        allocate(std::max(regionSize * 2, (GLsizeiptr)size));
+        start = 0;
+    }
+    head = start + size;
+    streamStats.bytes += size;
+
+    if (mapped) {
+        offset = (GLintptr)frames.getRegion() * regionSize + start;
+        return mapped + offset;
+    }
+    offset = start;
+    glBindBuffer(target, buffer);
+    void* data = glMapBufferRange(target, start, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    glBindBuffer(target, 0);
+    if (!data) {
+        std::cerr << "ERROR::STREAMBUFFER::MAP FAILED" << std::endl;
+    }
+    return data;
+}
+
+void StreamBuffer::unmap() {
+    // coherent, writes are seen by every command issued after them
+    if (mapped) {
+        return;
+    }
+    glBindBuffer(target, buffer);
+    glUnmapBuffer(target);
+    glBindBuffer(target, 0);
+}
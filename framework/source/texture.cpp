@@ -1,7 +1,10 @@
 #include "texture.hpp"
 #include "utils.hpp"
+#include "glState.hpp"
 
 #include "stb_image.hpp"
+#include "cubeSphere.hpp"
+#include "procedural.hpp"
 
 #include <iostream>
 
@@ -47,6 +50,53 @@ void Texture::set2DTexture(const GLenum& wrapper, const GLenum& filter) {
     stbi_image_free(data);
 }
 
-void Texture::bind() {
-    glBindTexture(GL_TEXTURE_2D, texture);
+// planet maps are equirectangular, reproject them into a cube-sphere on import
+// so texel density is uniform and the pole singularity disappears
+void Texture::setCubeSphereTexture(const GLenum& filter) {
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(false);
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 3);
+    if (data) {
+        // same texel density as the equirectangular map along the equator
+        int faceSize = width / 4 > 0 ? width / 4 : 1;
+        std::vector<unsigned char> faces = reprojectToCubeSphere(data, width, height, 3, faceSize);
+        uploadCubeFaces(faces.data(), faceSize, filter);
+    }
+    else {
+        std::cerr << "ERROR::TEXTURE::FAILED TO LOAD::" << path << std::endl;
+    }
+    stbi_image_free(data);
+}
+
+// bodies without a map get a generated surface, cached on disk after the first run
+void Texture::setProceduralTexture(unsigned int seed, int faceSize, const GLenum& filter) {
+    path = "procedural:" + std::to_string(seed);
+    std::vector<unsigned char> faces = proceduralSurface(seed, faceSize);
+    uploadCubeFaces(faces.data(), faceSize, filter);
+}
+
+void Texture::uploadCubeFaces(const unsigned char* faces, int faceSize, const GLenum& filter) {
+    target = GL_TEXTURE_CUBE_MAP;
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, filter == GL_LINEAR ? GL_LINEAR_MIPMAP_LINEAR : filter);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, filter);
+
+    size_t faceBytes = (size_t)faceSize * faceSize * 3;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (unsigned int i = 0; i < 6; i++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB8, faceSize, faceSize, 0, GL_RGB, GL_UNSIGNED_BYTE, faces + i * faceBytes);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+}
+
+void Texture::bind(unsigned int unit) {
+    GLState::get().bindTexture(unit, target, texture);
 }
@@ -0,0 +1,27 @@
+#include "uniformBuffer.hpp"
+
+#include <cstring>
+
+void UniformBuffer::create(GLsizeiptr size, GLuint aBinding) {
+    binding = aBinding;
+    shadow.assign(size, 0);
+
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferData(GL_UNIFORM_BUFFER, size, shadow.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+}
+
+bool UniformBuffer::update(const void* data, GLsizeiptr size, GLintptr offset) {
+    if (std::memcmp(shadow.data() + offset, data, size) == 0) {
+        return false;
+    }
+    std::memcpy(shadow.data() + offset, data, size);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return true;
+}
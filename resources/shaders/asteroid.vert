@@ -2,18 +2,38 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 layout (location = 2) in vec3 aNormal;
+// per-instance position in xyz and scale in w, written by AsteroidBelt every frame
+layout (location = 3) in vec4 aInstance;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frameData.glsl"
+#include "depthVertex.glsl"
 
 out vec3 pass_normal;
 out vec2 pass_texCoord;
 out vec3 pass_fragPos;
 
+float hash(float n) {
+    return fract(sin(n) * 43758.5453);
+}
+
+// fixed random orientation per rock; culling reorders the instances every
+// frame, so the seed is the rock's random scale rather than gl_InstanceID
+mat3 instanceRotation() {
+    float id = fract(aInstance.w * 977.0) * 1000.0;
+    vec3 axis = normalize(vec3(hash(id), hash(id + 17.0), hash(id + 31.0)) - 0.5 + 1e-3);
+    float angle = 6.28318530718 * hash(id + 57.0);
+    float c = cos(angle), s = sin(angle), t = 1.0 - c;
+    return mat3(t * axis.x * axis.x + c,          t * axis.x * axis.y + s * axis.z, t * axis.x * axis.z - s * axis.y,
+                t * axis.x * axis.y - s * axis.z, t * axis.y * axis.y + c,          t * axis.y * axis.z + s * axis.x,
+                t * axis.x * axis.z + s * axis.y, t * axis.y * axis.z - s * axis.x, t * axis.z * axis.z + c);
+}
+
 void main() {
-    pass_fragPos = vec3(model * vec4(aPos, 1.0));
+    mat3 rotation = instanceRotation();
+    // instances are in world space, lighting and the view work in render space
+    pass_fragPos = worldOrigin + aInstance.xyz + rotation * (aPos * aInstance.w);
     pass_texCoord = aTexCoord;
-    pass_normal = normalize(aNormal);
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    pass_normal = rotation * normalize(aNormal);
+    gl_Position = projection * view * vec4(pass_fragPos, 1.0);
+    outputDepth();
+}
@@ -6,8 +6,7 @@ layout (location = 2) in vec3 aNormal;
 out vec2 TexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frameData.glsl"
 
 void main()
 {
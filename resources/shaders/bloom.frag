@@ -7,27 +7,53 @@ uniform sampler2D scene;
 uniform sampler2D bloomBlur;
 uniform float exposure;
 uniform float gamma;
-uniform bool blur;
-uniform bool bloomFlag;
-uniform bool grayscale;
-uniform bool verticalMirror;
-uniform bool horizontalMirror;
+// dynamic resolution: the scene and its blur fill this corner of their
+// targets, and the upscale is sharpened by this much
+uniform vec2 uvScale = vec2(1.0);
+uniform float sharpness = 0.0;
 
 const float offset = 1.0 / 300.0;  
 
-void main() {             
-    vec3 hdrColor = texture(scene, TexCoords).rgb;      
-    vec3 bloomColor = texture(bloomBlur, TexCoords).rgb;
-    if (bloomFlag) {
-        hdrColor += bloomColor; // additive blending
+vec2 uvMax;
+
+// uv over the whole screen, clamped inside the drawn corner
+vec3 sampleScene(vec2 uv) {
+    return texture(scene, min(uv * uvScale, uvMax)).rgb;
+}
+
+// unsharp mask on the bilinear upscale, limited to the neighbours' range
+// so edges do not ring
+vec3 sharpenScene(vec2 uv) {
+    vec3 center = sampleScene(uv);
+    if (sharpness <= 0.0) {
+        return center;
     }
+    vec2 texel = 1.0 / (vec2(textureSize(scene, 0)) * uvScale);
+    vec3 a = sampleScene(uv + vec2(texel.x, 0.0));
+    vec3 b = sampleScene(uv - vec2(texel.x, 0.0));
+    vec3 c = sampleScene(uv + vec2(0.0, texel.y));
+    vec3 d = sampleScene(uv - vec2(0.0, texel.y));
+    vec3 low = min(center, min(min(a, b), min(c, d)));
+    vec3 high = max(center, max(max(a, b), max(c, d)));
+    vec3 sharpened = center + sharpness * (center - 0.25 * (a + b + c + d));
+    return clamp(sharpened, low, high);
+}
+
+void main() {             
+    uvMax = uvScale - 0.5 / vec2(textureSize(scene, 0));
+    vec3 hdrColor = sharpenScene(TexCoords);      
+#ifdef BLOOM
+    vec3 bloomColor = texture(bloomBlur, min(TexCoords * uvScale, uvMax)).rgb;
+    hdrColor += bloomColor; // additive blending
+#endif
     // tone mapping
     vec3 result = vec3(1.0) - exp(-hdrColor * exposure);
     // also gamma correct while we're at it       
     result = pow(result, vec3(1.0 / gamma));
     FragColor = vec4(result, 1.0);
 
-    if (blur) {
+#ifdef BLUR
+    {
         vec2 offsets[9] = vec2[](
             vec2(-offset,  offset), // top-left
             vec2( 0.0f,    offset), // top-center
@@ -48,7 +74,7 @@ void main() {
 
         vec3 sampleTex[9];
         for(int i = 0; i < 9; i++) {
-            sampleTex[i] = vec3(texture(scene, TexCoords.st + offsets[i]));
+            sampleTex[i] = sampleScene(TexCoords.st + offsets[i]);
         }
         vec3 col = vec3(0.0);
         for(int i = 0; i < 9; i++) {
@@ -57,17 +83,18 @@ void main() {
 
         FragColor = vec4(col, 1.0);
     }
+#endif
 
-    if (horizontalMirror) {
-		FragColor = texture(scene, vec2(TexCoords.x, 1 - TexCoords.y));
-    }
-    if (verticalMirror) {
-        FragColor = texture(scene, vec2(1 - TexCoords.x, TexCoords.y));
-    }
+#ifdef HORIZONTAL_MIRROR
+    FragColor = vec4(sampleScene(vec2(TexCoords.x, 1 - TexCoords.y)), 1.0);
+#endif
+#ifdef VERTICAL_MIRROR
+    FragColor = vec4(sampleScene(vec2(1 - TexCoords.x, TexCoords.y)), 1.0);
+#endif
 
-    if (grayscale) {
-        float luminance = 0.2126 * FragColor.r + 0.7152 * FragColor.g + 0.0722 * FragColor.b;
-        FragColor = vec4(luminance, luminance, luminance, 1.0);
-    }
+#ifdef GRAYSCALE
+    float luminance = 0.2126 * FragColor.r + 0.7152 * FragColor.g + 0.0722 * FragColor.b;
+    FragColor = vec4(luminance, luminance, luminance, 1.0);
+#endif
 }
 
@@ -7,19 +7,30 @@ uniform sampler2D image;
 
 uniform bool horizontal;
 uniform float weight[5] = float[] (0.2270270270, 0.1945945946, 0.1216216216, 0.0540540541, 0.0162162162);
+// the scene only fills this corner of the image under dynamic resolution
+uniform vec2 uvScale = vec2(1.0);
+
+vec2 uvMax;
+
+// clamped like the edge of the texture, nothing stale past the drawn corner bleeds in
+vec3 sampleImage(vec2 uv) {
+    return texture(image, min(uv, uvMax)).rgb;
+}
 
 void main() {             
     vec2 tex_offset = 1.0 / textureSize(image, 0); // gets size of single texel
-    vec3 result = texture(image, TexCoords).rgb * weight[0];
+    uvMax = uvScale - 0.5 * tex_offset;
+    vec2 uv = TexCoords * uvScale;
+    vec3 result = sampleImage(uv) * weight[0];
     if(horizontal) {
         for(int i = 1; i < 5; ++i) {
-            result += texture(image, TexCoords + vec2(tex_offset.x * i, 0.0)).rgb * weight[i];
-            result += texture(image, TexCoords - vec2(tex_offset.x * i, 0.0)).rgb * weight[i];
+            result += sampleImage(uv + vec2(tex_offset.x * i, 0.0)) * weight[i];
+            result += sampleImage(uv - vec2(tex_offset.x * i, 0.0)) * weight[i];
         }
     } else {
         for(int i = 1; i < 5; ++i) {
-            result += texture(image, TexCoords + vec2(0.0, tex_offset.y * i)).rgb * weight[i];
-            result += texture(image, TexCoords - vec2(0.0, tex_offset.y * i)).rgb * weight[i];
+            result += sampleImage(uv + vec2(0.0, tex_offset.y * i)) * weight[i];
+            result += sampleImage(uv - vec2(0.0, tex_offset.y * i)) * weight[i];
         }
     }
     FragColor = vec4(result, 1.0);
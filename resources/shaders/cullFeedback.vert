@@ -0,0 +1,9 @@
+#version 330 core
+// one point per instance, the geometry stage drops the ones outside the frustum
+layout (location = 0) in vec4 aInstance;
+
+out vec4 pass_instance;
+
+void main() {
+    pass_instance = aInstance;
+}
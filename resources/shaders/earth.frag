@@ -1,68 +1,41 @@
 #version 330 core
-uniform vec3 viewPos;
-uniform vec3 LightPosition;
-uniform vec3 LightColor;
-uniform float LightIntensity;
-uniform float LightConstant;
-uniform float LightLinear;
-uniform float LightQuadratic;
-uniform float Shininess;
-uniform float Reflectivity;
-uniform float AmbientVal;
-uniform bool outline;
-uniform sampler2D texture1;
-uniform sampler2D texture2;
-uniform sampler2D texture3;
+#include "depthFragment.glsl"
+#include "frameData.glsl"
+#include "lighting.glsl"
+uniform samplerCube texture1;
+uniform samplerCube texture2;
+uniform samplerCube texture3;
 
 in vec3 fragPos;
 in vec3 normal;
 in vec2 passTexCoord;
+in vec3 passDirection;
 
 out vec4 out_Color;
 
 void main() {
+    writeDepth();
+    vec3 n = normalize(normal);
     vec3 viewDir = normalize(viewPos - fragPos);
-    float angle = degrees(acos(dot(normal, viewDir) / (length(normal) * length(viewDir))));
-    
-    if (angle > 80.0 && angle < 100.0 && outline) {
-        out_Color = vec4(1.0, 1.0, 1.0, 1.0);
-    } else {
-        float surface, clouds, lights; 
-
-        surface = 0.5; clouds = 1.0 - surface;
-        vec3 tex12 = vec3(texture2D(texture1, passTexCoord) * surface + 
-                          texture2D(texture2, passTexCoord) * clouds).xyz;
-        
-        clouds = 0.5; lights = 1.0 - clouds;
-        vec3 tex23 = vec3(texture2D(texture2, passTexCoord) * clouds +
-                          texture2D(texture3, passTexCoord) * lights).xyz;
-       
-        surface = 0.5; clouds = 0.5; lights = 1.0 - surface - clouds;
-        vec3 tex123 = vec3(texture2D(texture1, passTexCoord) * surface + 
-                           texture2D(texture2, passTexCoord) * clouds +
-                           texture2D(texture3, passTexCoord) * lights).xyz;
-        // ambient
-        vec3 ambient = AmbientVal * tex12;
 
-        // diffuse
-        vec3 lightDirection = normalize(LightPosition - fragPos);
-        float diff = max(dot(lightDirection, normal), 0.0);
-        vec3 diffuse = diff * tex12;
+#ifdef OUTLINE
+    if (isOutline(n, viewDir)) {
+        out_Color = vec4(1.0, 1.0, 1.0, 1.0);
+        return;
+    }
+#endif
 
-        // specular
-        vec3 reflectDir = reflect(-lightDirection, normal);
-        vec3 centreDirection = normalize(lightDirection + viewDir);  
-        float spec = pow(max(dot(normal, centreDirection), 0.0), Shininess);
-        vec3 specular = vec3(Reflectivity) * spec;
+#ifdef FLAT_MAP
+    // unrolled map on a quad, rebuild the sphere direction from its coords
+    float lon = (passTexCoord.x - 0.5) * 6.28318530718;
+    float lat = (passTexCoord.y - 0.5) * 3.14159265359;
+    vec3 direction = vec3(cos(lat) * sin(lon), sin(lat), cos(lat) * cos(lon));
+#else
+    vec3 direction = passDirection;
+#endif
 
-        // attenuation
-        float distance = length(LightPosition - fragPos);
-        float attenuation = LightIntensity / (LightConstant + LightLinear * distance + LightQuadratic * (distance * distance));  
-    
-        ambient  *= attenuation;
-        diffuse  *= attenuation;
-        specular *= attenuation;
+    // surface and clouds blended half and half
+    vec3 tex12 = texture(texture1, direction).xyz * 0.5 + texture(texture2, direction).xyz * 0.5;
 
-        out_Color = vec4(ambient + diffuse + specular, 1.0);
-    }
+    out_Color = vec4(shade(tex12, fragPos, n, viewDir), 1.0);
 }
@@ -1,4 +1,5 @@
 #version 330 core
+#include "depthFragment.glsl"
 out vec4 FragColor;
 
 in vec2 TexCoords;
@@ -7,6 +8,7 @@ uniform sampler2D texture1;
 
 void main()
 {    
+    writeDepth();
     FragColor = texture(texture1, TexCoords);
     //FragColor = vec4(1.0, 1.0, 1.0, 1.0);
 }
\ No newline at end of file
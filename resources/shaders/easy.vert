@@ -5,12 +5,14 @@ layout (location = 2) in vec3 aNormal;
 
 out vec2 TexCoords;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "instance.glsl"
+#include "frameData.glsl"
+#include "depthVertex.glsl"
 
 void main()
 {
+    mat4 model = instanceModel();
     TexCoords = aTexCoords;    
     gl_Position = projection * view * model * vec4(aPos, 1.0);
+    outputDepth();
 }
\ No newline at end of file
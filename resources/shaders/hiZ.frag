@@ -0,0 +1,23 @@
+#version 330 core
+// one level of the hi-z pyramid, every texel keeps the farthest depth of the
+// 2x2 texels below it, the smallest with reversed-z; the sampler's base level
+// is the level below
+uniform sampler2D source;
+
+out float farthest;
+
+void main() {
+    ivec2 size = textureSize(source, 0);
+    ivec2 target = ivec2(gl_FragCoord.xy);
+    ivec2 base = target * 2;
+    // an odd row or column left over below is folded into the last texel
+    ivec2 extent = ivec2(2) + ivec2(equal(size & 1, ivec2(1))) * ivec2(equal(target, size / 2 - 1));
+
+    float depth = 1.0;
+    for (int y = 0; y < extent.y; y++) {
+        for (int x = 0; x < extent.x; x++) {
+            depth = min(depth, texelFetch(source, min(base + ivec2(x, y), size - 1), 0).r);
+        }
+    }
+    farthest = depth;
+}
@@ -0,0 +1,13 @@
+// reversed-z, 1 at the near plane and 0 at infinity (reversedZ.hpp); with
+// glClipControl the projection writes it, LOG_DEPTH is defined without it and
+// the fragment stage writes a logarithmic depth instead
+const float logDepthFar = 1e10;
+
+// the depth buffer value at a view distance
+float reversedDepth(float distance, float nearPlane) {
+#ifdef LOG_DEPTH
+    return 1.0 - log2(1.0 + distance) / log2(1.0 + logDepthFar);
+#else
+    return nearPlane / distance;
+#endif
+}
@@ -0,0 +1,12 @@
+// the matching fragment side, writeDepth() comes first in main
+#include "depth.glsl"
+
+#ifdef LOG_DEPTH
+in float pass_viewDistance;
+#endif
+
+void writeDepth() {
+#ifdef LOG_DEPTH
+    gl_FragDepth = reversedDepth(pass_viewDistance, 0.0);
+#endif
+}
@@ -0,0 +1,10 @@
+// every vertex shader that draws into the scene calls outputDepth() after gl_Position
+#ifdef LOG_DEPTH
+out float pass_viewDistance;
+#endif
+
+void outputDepth() {
+#ifdef LOG_DEPTH
+    pass_viewDistance = gl_Position.w;
+#endif
+}
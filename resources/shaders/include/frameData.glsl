@@ -0,0 +1,12 @@
+// per-frame camera and light data, filled by uploadFrameData (std140, binding frameDataBinding)
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float LightIntensity;
+    vec3 LightPosition;
+    float LightConstant;
+    float LightLinear;
+    float LightQuadratic;
+    vec3 worldOrigin;
+};
@@ -0,0 +1,45 @@
+// hierarchical-z occlusion test, the same math as HiZ::occluded on the cpu
+#include "depth.glsl"
+
+uniform sampler2D hiZ;
+uniform mat4 hiZView;
+uniform mat4 hiZProjection;
+uniform ivec2 hiZSize;   // the drawn part of the depth buffer, pyramid level 0 is half of it
+uniform int hiZLevels;
+
+// true if the sphere is behind the farthest depth everywhere it covers
+bool hiZOccluded(vec3 center, float radius) {
+    vec3 c = (hiZView * vec4(center, 1.0)).xyz;
+    float nearest = -c.z - radius;
+    // reaches the camera plane, the rect would be unbounded
+    if (nearest <= 0.0) {
+        return false;
+    }
+    float farthest = -c.z + radius;
+
+    // the view-space box around the sphere, each edge divided by whichever
+    // depth pushes it further out, contains the sphere's projection
+    vec2 scale = vec2(hiZProjection[0][0], hiZProjection[1][1]);
+    vec2 low = c.xy - radius;
+    vec2 high = c.xy + radius;
+    low = low / mix(vec2(farthest), vec2(nearest), lessThan(low, vec2(0.0))) * scale;
+    high = high / mix(vec2(farthest), vec2(nearest), greaterThan(high, vec2(0.0))) * scale;
+    // off screen, that is the frustum test's call
+    if (any(greaterThanEqual(low, vec2(1.0))) || any(lessThanEqual(high, vec2(-1.0)))) {
+        return false;
+    }
+
+    // depth buffer pixels, then the level where the rect spans at most 2x2 texels:
+    // level l halves them l + 1 times, so a span below 2^(l + 1) touches two cells
+    ivec2 a = ivec2((clamp(low, -1.0, 1.0) * 0.5 + 0.5) * vec2(hiZSize));
+    ivec2 b = ivec2((clamp(high, -1.0, 1.0) * 0.5 + 0.5) * vec2(hiZSize));
+    int level = clamp(findMSB(max(b.x - a.x, b.y - a.y)), 0, hiZLevels - 1);
+    ivec2 last = textureSize(hiZ, level) - 1;
+    a = min(a >> (level + 1), last);
+    b = min(b >> (level + 1), last);
+
+    // reversed-z, the farthest depth is the smallest value
+    float depth = min(min(texelFetch(hiZ, a, level).r, texelFetch(hiZ, ivec2(b.x, a.y), level).r),
+                      min(texelFetch(hiZ, ivec2(a.x, b.y), level).r, texelFetch(hiZ, b, level).r));
+    return reversedDepth(nearest, hiZProjection[3][2]) < depth;
+}
@@ -0,0 +1,9 @@
+// model matrices of one batch of merged draws, written by the render queue;
+// a single draw is a batch of one
+layout (std140) uniform Instances {
+    mat4 models[64];
+};
+
+mat4 instanceModel() {
+    return models[gl_InstanceID];
+}
@@ -0,0 +1,28 @@
+#include "material.glsl"
+
+// blinn-phong lit by the sun with distance attenuation, needs frameData.glsl
+vec3 shade(vec3 albedo, vec3 position, vec3 normal, vec3 viewDir) {
+    // ambient
+    vec3 ambient = AmbientVal * albedo;
+
+    // diffuse
+    vec3 lightDirection = normalize(LightPosition - position);
+    float diff = max(dot(lightDirection, normal), 0.0);
+    vec3 diffuse = diff * albedo;
+
+    // specular
+    vec3 centreDirection = normalize(lightDirection + viewDir);
+    float spec = pow(max(dot(normal, centreDirection), 0.0), Shininess);
+    vec3 specular = vec3(Reflectivity) * spec;
+
+    // attenuation
+    float distance = length(LightPosition - position);
+    float attenuation = LightIntensity / (LightConstant + LightLinear * distance + LightQuadratic * (distance * distance));
+
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+// silhouette band between 80 and 100 degrees, cos(80) instead of acos per fragment
+bool isOutline(vec3 normal, vec3 viewDir) {
+    return abs(dot(normal, viewDir)) < 0.173648;
+}
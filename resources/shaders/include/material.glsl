@@ -0,0 +1,6 @@
+// surface parameters of the bound Material range (std140, binding materialBinding)
+layout(std140) uniform Material {
+    float Shininess;
+    float AmbientVal;
+    float Reflectivity;
+};
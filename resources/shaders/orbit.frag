@@ -1,7 +1,9 @@
 #version 330 core
+#include "depthFragment.glsl"
 
 out vec4 out_Color;
 
 void main() {
+    writeDepth();
   out_Color = vec4(0.25, 0.25, 0.25, 1.0);
 }
\ No newline at end of file
@@ -1,11 +1,11 @@
 #version 330 core
-layout (location = 0) in float aPos1;
-layout (location = 1) in float aPos2;
+layout (location = 0) in vec3 aPos;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frameData.glsl"
+#include "depthVertex.glsl"
 
 void main(void) {
-	gl_Position = projection * view * model * vec4(aPos2, 0.0, aPos1, 1.0);
+	// tessellated on the cpu, already in render space
+	gl_Position = projection * view * vec4(aPos, 1.0);
+	outputDepth();
 }
\ No newline at end of file
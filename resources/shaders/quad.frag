@@ -4,10 +4,6 @@ out vec4 out_Color;
 in vec2 pass_Texture_Coordinates;
 
 uniform sampler2D texture1;
-uniform bool blur;
-uniform bool grayscale;
-uniform bool verticalMirror;
-uniform bool horizontalMirror;
 uniform float exposure;
 uniform float gamma;
 
@@ -27,8 +23,8 @@ void main() {
     out_Color = vec4(result , 1.0);
     //out_Color = texture(texture1, pass_Texture_Coordinates);
     
-    if (blur) {
-        
+#ifdef BLUR
+    {
         vec2 offsets[9] = vec2[](
             vec2(-offset,  offset), // top-left
             vec2( 0.0f,    offset), // top-center
@@ -58,21 +54,20 @@ void main() {
 
         out_Color = vec4(col, 1.0);
     }
+#endif
 
-    if (verticalMirror && horizontalMirror) {
-        out_Color = texture(texture1, vec2(1 - pass_Texture_Coordinates.x, 1 - pass_Texture_Coordinates.y));
-    }
-    else if (horizontalMirror) {
-    	out_Color = texture(texture1, vec2(pass_Texture_Coordinates.x, 1 - pass_Texture_Coordinates.y));
-    }
-    else if (verticalMirror) {
-        out_Color = texture(texture1, vec2(1 - pass_Texture_Coordinates.x, pass_Texture_Coordinates.y));
-    }
+#if defined(VERTICAL_MIRROR) && defined(HORIZONTAL_MIRROR)
+    out_Color = texture(texture1, vec2(1 - pass_Texture_Coordinates.x, 1 - pass_Texture_Coordinates.y));
+#elif defined(HORIZONTAL_MIRROR)
+    out_Color = texture(texture1, vec2(pass_Texture_Coordinates.x, 1 - pass_Texture_Coordinates.y));
+#elif defined(VERTICAL_MIRROR)
+    out_Color = texture(texture1, vec2(1 - pass_Texture_Coordinates.x, pass_Texture_Coordinates.y));
+#endif
 
-    if (grayscale) {
-        float luminance = 0.2126 * out_Color.r + 0.7152 * out_Color.g + 0.0722 * out_Color.b;
-        out_Color = vec4(luminance, luminance, luminance, 1.0);
-    }
+#ifdef GRAYSCALE
+    float luminance = 0.2126 * out_Color.r + 0.7152 * out_Color.g + 0.0722 * out_Color.b;
+    out_Color = vec4(luminance, luminance, luminance, 1.0);
+#endif
 
 } 
 
@@ -6,6 +6,9 @@ in vec3 TexCoords;
 uniform samplerCube skybox;
 
 void main() {    
+#ifdef LOG_DEPTH
+    gl_FragDepth = 0.0;
+#endif
     FragColor = texture(skybox, TexCoords);
     //FragColor = vec4(1.0, 1.0, 1.0, 1.0);
 }
@@ -3,13 +3,13 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include "frameData.glsl"
 uniform mat4 model;
 
 void main() {
     TexCoords = aPos;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    //vec4 pos = inverse(projection * view) * vec4(aPos, 1.0);
-    //gl_Position = pos.xyww;
+    // pinned to infinity, depth 0 with the reversed-z projection, so it stays
+    // behind bodies farther away than the cube itself
+    vec4 position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = vec4(position.xy, 0.0, position.w);
 }  
\ No newline at end of file
@@ -4,5 +4,10 @@ out vec4 out_Color;
 in vec3 pass_color;
 
 void main() {
-    out_Color = vec4(1.0, 1.0, 1.0, 1.0);
+#ifdef LOG_DEPTH
+    gl_FragDepth = 0.0;
+#endif
+    // round sprites fading out towards their edge, added onto the sky
+    vec2 p = gl_PointCoord * 2.0 - 1.0;
+    out_Color = vec4(pass_color * exp(-4.0 * dot(p, p)), 1.0);
 }
\ No newline at end of file
@@ -1,10 +1,58 @@
 #version 330 core
-layout(location = 0) in vec3 in_Position;
+// as packed by StarCatalogue: octahedral direction, then magnitude and colour index
+layout(location = 0) in vec2 in_Direction;
+layout(location = 1) in vec2 in_Appearance;
 
-uniform mat4 model;
-uniform mat4 projection;
-uniform mat4 view;
+#include "frameData.glsl"
+
+// the quantization ranges in starCatalogue.hpp
+const float magnitudeMin = -2.0;
+const float magnitudeMax = 14.0;
+const float colourMin = -0.5;
+const float colourMax = 2.5;
+
+// B-V against the colour a star of it shows, blue giants to red dwarfs
+const int colourStops = 7;
+const float stopIndex[colourStops] = float[](-0.33, 0.0, 0.3, 0.6, 1.0, 1.5, 2.0);
+const vec3 stopColour[colourStops] = vec3[](
+    vec3(0.61, 0.69, 1.00), vec3(0.79, 0.85, 1.00), vec3(0.97, 0.97, 1.00), vec3(1.00, 0.94, 0.85),
+    vec3(1.00, 0.83, 0.64), vec3(1.00, 0.71, 0.45), vec3(1.00, 0.60, 0.35));
+
+uniform float limit;
+// sprite sizes are in screen pixels, the scene may be drawn smaller
+uniform float pointScale;
+
+out vec3 pass_color;
+
+vec3 octahedralDecode(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0) {
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(v);
+}
+
+vec3 starColour(float index) {
+    vec3 colour = stopColour[0];
+    for (int i = 1; i < colourStops; i++) {
+        float t = clamp((index - stopIndex[i - 1]) / (stopIndex[i] - stopIndex[i - 1]), 0.0, 1.0);
+        colour = index > stopIndex[i - 1] ? mix(stopColour[i - 1], stopColour[i], t) : colour;
+    }
+    return colour;
+}
 
 void main() {
-	gl_Position = projection * view * model * vec4(in_Position, 1.0);
+    float magnitude = mix(magnitudeMin, magnitudeMax, in_Appearance.x);
+    float index = mix(colourMin, colourMax, in_Appearance.y);
+
+    // at infinity, depth 0 like the skybox they are drawn over
+    vec4 position = projection * view * vec4(octahedralDecode(in_Direction), 0.0);
+    gl_Position = vec4(position.xy, 0.0, position.w);
+
+    // a magnitude is 10^0.4 in flux; the faintest drawn get a tenth, stars 2.5
+    // magnitudes above the limit full white and brighter ones reach into bloom
+    float above = limit - magnitude;
+    float flux = min(pow(10.0, 0.4 * (above - 2.5)), 4.0);
+    gl_PointSize = clamp(1.0 + 0.5 * above, 1.0, 6.0) * pointScale;
+    pass_color = starColour(index) * flux;
 }
\ No newline at end of file
@@ -4,8 +4,7 @@ layout (location = 1) in vec2 aTexCoord;
 layout (location = 2) in vec3 aNormal;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "frameData.glsl"
 
 out vec2 outTexCoord;
 
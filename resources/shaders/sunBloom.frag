@@ -1,4 +1,5 @@
 #version 330 core
+#include "depthFragment.glsl"
 layout (location = 0) out vec4 FragColor;
 layout (location = 1) out vec4 BrightColor;
 
@@ -6,16 +7,18 @@ in VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
+    vec3 Direction;
 } fs_in;
 
 uniform float glow;
-uniform sampler2D texture1;
+uniform samplerCube texture1;
 
 void main()
 {           
-    vec4 color = vec4(texture(texture1, fs_in.TexCoords).x * glow,
-                      texture(texture1, fs_in.TexCoords).y * glow,
-                      texture(texture1, fs_in.TexCoords).z * glow,
+    writeDepth();
+    vec4 color = vec4(texture(texture1, fs_in.Direction).x * glow,
+                      texture(texture1, fs_in.Direction).y * glow,
+                      texture(texture1, fs_in.Direction).z * glow,
                       1.0);
     FragColor = color;
     float brightness = dot(FragColor.rgb, vec3(0.2126, 0.7152, 0.0722));
@@ -7,20 +7,24 @@ out VS_OUT {
     vec3 FragPos;
     vec3 Normal;
     vec2 TexCoords;
+    vec3 Direction;
 } vs_out;
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
+#include "frameData.glsl"
+#include "depthVertex.glsl"
+#include "instance.glsl"
 
 void main()
 {
+    mat4 model = instanceModel();
     vs_out.FragPos = vec3(model * vec4(aPos, 1.0));   
     vs_out.TexCoords = aTexCoords;
+    vs_out.Direction = aPos;
         
     mat3 normalMatrix = transpose(inverse(mat3(model)));
     vs_out.Normal = normalize(normalMatrix * aNormal);
     
     gl_Position = projection * view * model * vec4(aPos, 1.0);
+    outputDepth();
 }
 
@@ -0,0 +1,11 @@
+#version 330 core
+in vec2 pass_TexCoord;
+in vec4 pass_Color;
+
+uniform sampler2D texture1;
+
+out vec4 out_Color;
+
+void main() {
+    out_Color = pass_Color * texture(texture1, pass_TexCoord);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 330 core
+// ImDrawVert: position and uv in ImGui's display space, colour as 4 bytes
+layout (location = 0) in vec2 in_Position;
+layout (location = 1) in vec2 in_TexCoord;
+layout (location = 2) in vec4 in_Color;
+
+uniform mat4 projection;
+
+out vec2 pass_TexCoord;
+out vec4 pass_Color;
+
+void main() {
+    pass_TexCoord = in_TexCoord;
+    pass_Color = in_Color;
+    gl_Position = projection * vec4(in_Position, 0.0, 1.0);
+}
\ No newline at end of file